@@ -0,0 +1,148 @@
+// JournalReplayBenchmark.cpp
+// Records a simulated trading day (one tick per second of a 6.5 hour session)
+// to an input journal, replays it into a fresh engine as fast as possible and
+// checks that both engines end in the same state.
+
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "InputJournal.h"
+#include "Market.h"
+#include "Portfolio.h"
+#include "TradingEngine.h"
+
+namespace {
+const int SESSION_STEPS = 23400;
+const size_t MAX_WORKING_ORDERS = 200;
+
+// Quotes around the touch, cancels stale quotes and occasionally crosses
+class QuotingStrategy : public IStrategy
+{
+public:
+    std::string name() const override { return "Quoting"; }
+
+    void onTick(Market &market, Portfolio &portfolio, TradingEngine &engine, int /*step*/) override
+    {
+        const MarketSnapshot &snap = market.getSnapshot();
+        const std::vector<std::string> &symbols = market.getSymbolsByIndex();
+        std::uniform_real_distribution<double> offset(-0.002, 0.002);
+
+        for (size_t i = 0; i < snap.size(); ++i)
+        {
+            OrderType side = random() % 2 ? OrderType::BUY : OrderType::SELL;
+            double price = snap.prices[i] * (1.0 + offset(random));
+            if (side == OrderType::SELL && portfolio.getPositionQuantity(symbols[i]) < 10.0)
+            {
+                side = OrderType::BUY;
+            }
+            Order order(symbols[i], side, 10.0, std::round(price * 100.0) / 100.0);
+            order.setExecutionType(ExecutionType::LIMIT);
+            if (engine.submitOrder(order))
+            {
+                working.push_back(order.getOrderId());
+            }
+
+            if (random() % 50 == 0)
+            {
+                engine.executeMarketOrder(symbols[i], OrderType::BUY, 5.0);
+            }
+        }
+
+        while (working.size() > MAX_WORKING_ORDERS)
+        {
+            engine.cancelOrder(working.front());
+            working.pop_front();
+        }
+    }
+
+private:
+    std::mt19937 random{2024};
+    std::deque<int> working;
+};
+
+void setUpMarket(Market &market)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> price(20.0, 500.0);
+    std::uniform_real_distribution<double> vol(0.0005, 0.002);
+    for (int i = 0; i < 50; ++i)
+    {
+        market.addSymbol("SYM" + std::to_string(i), price(rng), vol(rng));
+    }
+}
+
+bool same(double a, double b)
+{
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(a));
+}
+}
+
+int main(int argc, char **argv)
+{
+    std::string path = argc > 1 ? argv[1] : "journal_benchmark.tjnl";
+
+    // Record the day
+    Market market;
+    setUpMarket(market);
+    Portfolio portfolio(10000000.0);
+    TradingEngine engine(market, portfolio);
+    engine.enableOrderLogging(false);
+    engine.setKeepExecutedOrders(false);
+    QuotingStrategy strategy;
+    engine.addStrategy(&strategy);
+
+    uint64_t recordCount;
+    {
+        InputJournal journal(path);
+        if (!journal.isOpen())
+        {
+            std::cerr << "Cannot open " << path << std::endl;
+            return 1;
+        }
+        engine.setJournal(&journal);
+        engine.runSimulation(SESSION_STEPS);
+        engine.setJournal(nullptr);
+        journal.close();
+        recordCount = journal.getRecordCount();
+    }
+    int nextOrderId = Order::getNextOrderId();
+
+    // Replay it into a fresh engine; strategies are not needed
+    Market replayMarket;
+    Portfolio replayPortfolio(10000000.0);
+    TradingEngine replayEngine(replayMarket, replayPortfolio);
+    replayEngine.enableOrderLogging(false);
+    replayEngine.setKeepExecutedOrders(false);
+    ReplayResult result = JournalReplayer::replay(path, replayMarket, replayEngine);
+    std::remove(path.c_str());
+    if (!result.ok)
+    {
+        std::cerr << "Replay failed: " << result.error << std::endl;
+        return 1;
+    }
+
+    bool identical = result.records == recordCount && !result.truncated &&
+                     replayEngine.getExecutedOrderCount() == engine.getExecutedOrderCount() &&
+                     replayEngine.getPendingOrderCount() == engine.getPendingOrderCount() &&
+                     replayEngine.getCurrentStep() == engine.getCurrentStep() &&
+                     same(replayEngine.getTotalFees(), engine.getTotalFees()) &&
+                     same(replayPortfolio.getCash(), portfolio.getCash()) &&
+                     same(replayPortfolio.getTotalValue(), portfolio.getTotalValue());
+    // Replay rewinds the id counter while it runs, but must not leave it rewound
+    bool idsKept = Order::getNextOrderId() >= nextOrderId;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "\n=== Journal Replay Benchmark ===\n"
+              << "Records:          " << result.records << " (" << result.ticks << " ticks, "
+              << result.calls << " calls)\n"
+              << "Executed orders:  " << replayEngine.getExecutedOrderCount() << "\n"
+              << "Replay time:      " << result.seconds * 1000.0 << " ms\n"
+              << "Throughput:       " << result.records / result.seconds / 1e6 << " M records/s, "
+              << result.ticks / result.seconds << " ticks/s\n"
+              << "End state:        " << (identical ? "identical" : "DIFFERENT") << "\n"
+              << "Order id counter: " << (idsKept ? "restored" : "REWOUND") << std::endl;
+    return identical && idsKept ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+// NumaScalingBenchmark.cpp
+// Runs a batch of independent quoting simulations with a growing number of
+// pinned workers: one worker, one full socket, then every CPU filled socket by
+// socket and spread round-robin across sockets. Each layout runs twice, once
+// with every instance built on the main thread (heap pages wherever the
+// allocator put them) and once through SimulationBatch, which builds each
+// instance on its worker over a node-local arena. Reports simulations/s,
+// steps/s and the scaling efficiency relative to one worker.
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Market.h"
+#include "NumaMemory.h"
+#include "Portfolio.h"
+#include "SimulationBatch.h"
+#include "TradingEngine.h"
+
+namespace {
+const int STEPS_PER_SIMULATION = 2000;
+const size_t SIMULATIONS_PER_WORKER = 4;
+const int SYMBOLS = 20;
+const size_t MAX_WORKING_ORDERS = 100;
+
+// One simulation instance: market, account, engine and a quoting loop
+class Instance
+{
+public:
+    Instance(unsigned int seed, std::pmr::memory_resource *memory)
+        : portfolio(10000000.0), engine(market, portfolio, 5.0, memory), random(seed)
+    {
+        std::uniform_real_distribution<double> price(20.0, 500.0);
+        std::uniform_real_distribution<double> vol(0.0005, 0.002);
+        for (int i = 0; i < SYMBOLS; ++i)
+        {
+            market.addSymbol("SYM" + std::to_string(i), price(random), vol(random));
+        }
+        engine.enableOrderLogging(false);
+        engine.setKeepExecutedOrders(false);
+        working.reserve(MAX_WORKING_ORDERS + SYMBOLS);
+    }
+
+    void run(int steps)
+    {
+        std::uniform_real_distribution<double> offset(-0.002, 0.002);
+        const std::vector<std::string> &symbols = market.getSymbolsByIndex();
+        for (int step = 0; step < steps; ++step)
+        {
+            market.updatePrices();
+            engine.markToMarket();
+
+            const MarketSnapshot &snap = market.getSnapshot();
+            for (size_t i = 0; i < snap.size(); ++i)
+            {
+                OrderType side = random() % 2 ? OrderType::BUY : OrderType::SELL;
+                if (side == OrderType::SELL && portfolio.getPositionQuantity(symbols[i]) < 10.0)
+                {
+                    side = OrderType::BUY;
+                }
+                double price = snap.prices[i] * (1.0 + offset(random));
+                Order order(symbols[i], side, 10.0, std::round(price * 100.0) / 100.0);
+                order.setExecutionType(ExecutionType::LIMIT);
+                if (engine.submitOrder(order))
+                {
+                    working.push_back(order.getOrderId());
+                }
+            }
+            // Cancel the oldest quotes, keeping the rest in order
+            if (working.size() > MAX_WORKING_ORDERS)
+            {
+                size_t excess = working.size() - MAX_WORKING_ORDERS;
+                for (size_t i = 0; i < excess; ++i)
+                {
+                    engine.cancelOrder(working[i]);
+                }
+                working.erase(working.begin(), working.begin() + excess);
+            }
+            engine.processOrders();
+        }
+    }
+
+    size_t getFills() const { return engine.getExecutedOrderCount(); }
+
+private:
+    Market market;
+    Portfolio portfolio;
+    TradingEngine engine;
+    std::mt19937 random;
+    std::vector<int> working;
+};
+
+struct Layout
+{
+    std::string name;
+    std::vector<size_t> cpus;
+};
+
+struct Measurement
+{
+    double seconds;
+    size_t simulations;
+    uint64_t fills;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Every instance built up front on the calling thread, then run on the workers
+Measurement runBuiltOnMainThread(SimulationBatch &batch, size_t simulations)
+{
+    batch.getCounters().reset();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<Instance>> instances;
+    instances.reserve(simulations);
+    for (size_t i = 0; i < simulations; ++i)
+    {
+        instances.emplace_back(new Instance(static_cast<unsigned int>(i + 1), std::pmr::get_default_resource()));
+    }
+
+    batch.run(simulations, [&](BatchJob &job) {
+        instances[job.index]->run(STEPS_PER_SIMULATION);
+        batch.getCounters().add(job.worker, SimulationBatch::STEPS, STEPS_PER_SIMULATION);
+        batch.getCounters().add(job.worker, SimulationBatch::FILLS, instances[job.index]->getFills());
+    });
+    instances.clear();
+    return {secondsSince(start), simulations, batch.getCounters().total(SimulationBatch::FILLS)};
+}
+
+// Each instance built, run and destroyed on its worker, over the job's arena
+Measurement runNodeLocal(SimulationBatch &batch, size_t simulations)
+{
+    batch.getCounters().reset();
+    auto start = std::chrono::steady_clock::now();
+    batch.run(simulations, [&](BatchJob &job) {
+        Instance instance(static_cast<unsigned int>(job.index + 1), job.arena.resource());
+        instance.run(STEPS_PER_SIMULATION);
+        batch.getCounters().add(job.worker, SimulationBatch::STEPS, STEPS_PER_SIMULATION);
+        batch.getCounters().add(job.worker, SimulationBatch::FILLS, instance.getFills());
+    });
+    return {secondsSince(start), simulations, batch.getCounters().total(SimulationBatch::FILLS)};
+}
+
+std::vector<Layout> layouts(const NumaTopology &topology)
+{
+    std::vector<Layout> result;
+    auto add = [&](const std::string &name, std::vector<size_t> cpus) {
+        for (const Layout &layout : result)
+        {
+            if (layout.cpus == cpus)
+            {
+                return;
+            }
+        }
+        result.push_back({name, std::move(cpus)});
+    };
+
+    size_t cpuCount = topology.getCpuCount();
+    add("1 worker", topology.selectCpus(1, false));
+    add("1 socket", topology.getCpus(0));
+    add("all, packed", topology.selectCpus(cpuCount, false));
+    add("all, spread", topology.selectCpus(cpuCount, true));
+    return result;
+}
+}
+
+int main()
+{
+    const NumaTopology &topology = NumaTopology::get();
+    std::cout << "\n=== NUMA Scaling Benchmark ===\n"
+              << "Nodes: " << topology.getNodeCount() << ", CPUs: " << topology.getCpuCount() << "\n";
+    for (size_t node = 0; node < topology.getNodeCount(); ++node)
+    {
+        std::cout << "  node " << topology.getNodeId(node) << ": " << topology.getCpus(node).size() << " CPUs\n";
+    }
+    std::cout << STEPS_PER_SIMULATION << " steps x " << SYMBOLS << " symbols per simulation, "
+              << SIMULATIONS_PER_WORKER << " simulations per worker\n\n";
+
+    std::cout << std::left << std::setw(14) << "layout" << std::right << std::setw(8) << "workers"
+              << std::setw(14) << "placement" << std::setw(12) << "sims/s" << std::setw(14) << "steps/s"
+              << std::setw(12) << "per worker" << std::setw(12) << "efficiency" << std::setw(10) << "fills" << "\n";
+
+    double baselinePerWorker[2] = {0.0, 0.0};
+    for (const Layout &layout : layouts(topology))
+    {
+        BatchConfig config;
+        config.cpus = layout.cpus;
+        SimulationBatch batch(config);
+        size_t workers = batch.getWorkerCount();
+        size_t simulations = workers * SIMULATIONS_PER_WORKER;
+
+        for (int placement = 0; placement < 2; ++placement)
+        {
+            Measurement result = placement == 0 ? runBuiltOnMainThread(batch, simulations)
+                                                : runNodeLocal(batch, simulations);
+            double simsPerSecond = result.simulations / result.seconds;
+            double perWorker = simsPerSecond / workers;
+            if (baselinePerWorker[placement] == 0.0)
+            {
+                baselinePerWorker[placement] = perWorker;
+            }
+
+            std::cout << std::left << std::setw(14) << layout.name << std::right << std::setw(8) << workers
+                      << std::setw(14) << (placement == 0 ? "main thread" : "node-local")
+                      << std::fixed << std::setprecision(1) << std::setw(12) << simsPerSecond
+                      << std::setprecision(0) << std::setw(14) << simsPerSecond * STEPS_PER_SIMULATION
+                      << std::setprecision(1) << std::setw(12) << perWorker
+                      << std::setw(11) << 100.0 * perWorker / baselinePerWorker[placement] << "%"
+                      << std::setw(10) << result.fills << "\n";
+        }
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,112 @@
+// ShardScalingBenchmark.cpp
+// Times processOrders serially and with a growing number of shards on a book
+// of many resting limit orders, most of them away from the market, plus a
+// few marketable orders per step. Only triggering and matching run on the
+// shard workers; fills are applied on the calling thread, so the speedup is
+// bounded by the share of the step spent matching. Reports steps/s, fills
+// and the speedup over serial matching.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Market.h"
+#include "Portfolio.h"
+#include "TradingEngine.h"
+
+namespace {
+const int SYMBOLS = 200;
+const int RESTING_PER_SYMBOL = 200;
+const int STEPS = 500;
+const int MARKETABLE_PER_STEP = 20;
+
+struct Result
+{
+    double seconds;
+    size_t fills;
+};
+
+Result run(size_t shards)
+{
+    Market market;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> price(20.0, 500.0);
+    for (int i = 0; i < SYMBOLS; ++i)
+    {
+        market.addSymbol("SYM" + std::to_string(i), price(rng), 0.001);
+    }
+    Portfolio portfolio(1e9);
+    TradingEngine engine(market, portfolio, 0.0);
+    engine.enableOrderLogging(false);
+    engine.setKeepExecutedOrders(false);
+    portfolio.setKeepOrderHistory(false);
+    engine.enableSharding(shards, false);
+
+    // Deep resting bids 5-15% below the market: scanned every step, rarely filled
+    const std::vector<std::string> &symbols = market.getAvailableSymbols();
+    std::uniform_real_distribution<double> depth(0.85, 0.95);
+    for (const std::string &symbol : symbols)
+    {
+        for (int k = 0; k < RESTING_PER_SYMBOL; ++k)
+        {
+            Order order(symbol, OrderType::BUY, 1.0, std::round(market.getCurrentPrice(symbol) * depth(rng) * 100.0) / 100.0);
+            order.setExecutionType(ExecutionType::LIMIT);
+            engine.submitOrder(order);
+        }
+    }
+
+    std::uniform_int_distribution<int> pick(0, SYMBOLS - 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < STEPS; ++step)
+    {
+        market.updatePrices();
+        engine.markToMarket();
+        for (int k = 0; k < MARKETABLE_PER_STEP; ++k)
+        {
+            const std::string &symbol = symbols[pick(rng)];
+            Order order(symbol, OrderType::BUY, 1.0, std::round(market.getCurrentPrice(symbol) * 101.0) / 100.0);
+            order.setExecutionType(ExecutionType::LIMIT);
+            engine.submitOrder(order);
+        }
+        engine.processOrders();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return {elapsed.count(), engine.getExecutedOrderCount()};
+}
+}
+
+int main()
+{
+    size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\n=== Shard Scaling Benchmark ===\n"
+              << SYMBOLS << " symbols x " << RESTING_PER_SYMBOL << " resting orders, " << STEPS << " steps, "
+              << cpus << " CPUs\n\n"
+              << std::left << std::setw(10) << "shards" << std::right << std::setw(12) << "steps/s"
+              << std::setw(10) << "fills" << std::setw(10) << "speedup" << "\n";
+
+    std::vector<size_t> counts = {1, 2, 4};
+    if (cpus > 4)
+    {
+        counts.push_back(cpus);
+    }
+    double serial = 0.0;
+    for (size_t shards : counts)
+    {
+        Result result = run(shards);
+        double stepsPerSecond = STEPS / result.seconds;
+        if (shards == 1)
+        {
+            serial = stepsPerSecond;
+        }
+        std::cout << std::left << std::setw(10) << (shards == 1 ? "serial" : std::to_string(shards)) << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(12) << stepsPerSecond << std::setw(10)
+                  << result.fills << std::setprecision(2) << std::setw(9) << stepsPerSecond / serial << "x\n";
+    }
+    std::cout << std::endl;
+    return 0;
+}
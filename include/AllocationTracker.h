@@ -0,0 +1,32 @@
+// AllocationTracker.h
+// Heap allocation counting for hot-path checks. When the build defines
+// TRADING_TRACK_ALLOCATIONS (CMake -DTRACK_ALLOCATIONS=ON, Debug builds, or
+// `make debug`), global operator new is replaced by a counting version;
+// otherwise every count reads zero and the calls compile to nothing.
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstdint>
+
+class AllocationTracker {
+public:
+    static bool isEnabled();
+
+    // Process-wide totals since startup
+    static uint64_t getAllocationCount();
+    static uint64_t getAllocatedBytes();
+
+    // Counts allocations made while the scope is alive (all threads)
+    class Scope {
+    private:
+        uint64_t startCount;
+        uint64_t startBytes;
+
+    public:
+        Scope() : startCount(getAllocationCount()), startBytes(getAllocatedBytes()) {}
+        uint64_t allocations() const { return getAllocationCount() - startCount; }
+        uint64_t bytes() const { return getAllocatedBytes() - startBytes; }
+    };
+};
+
+#endif // ALLOCATION_TRACKER_H
@@ -0,0 +1,102 @@
+// BarSeries.h
+// Streaming OHLCV bars at one resolution for every symbol of a Market. A
+// Market can keep several resolutions at once (see
+// Market::registerBarResolution); each tick updates the forming bar of every
+// resolution in O(1), and completed bars go into a fixed-capacity ring per
+// symbol. Readers get a BarView straight over the ring, so multi-timeframe
+// strategies never copy bars or rescan the raw price history.
+//
+// Resolutions are counted in price updates, the Market's clock: bar k of an
+// N-update series covers a symbol's updates [k*N, (k+1)*N). With one update
+// per step (updatePrices) that is N steps, and every resolution's bars start
+// on the same updates, so five 1-update bars make up exactly one 5-update bar.
+#ifndef BAR_SERIES_H
+#define BAR_SERIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Bar {
+    uint64_t start = 0;     // first price update of the bar
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    double volume = 0.0;
+    uint32_t ticks = 0;     // price updates so far
+};
+
+// Completed bars of one symbol, oldest first, viewed in place. The ring may
+// wrap, so the bars are the concatenation of two contiguous segments. A view
+// stays valid until the next price update of its Market.
+class BarView {
+private:
+    const Bar* data;
+    size_t capacity;
+    size_t head;
+    size_t count;
+
+public:
+    BarView() : data(nullptr), capacity(0), head(0), count(0) {}
+    BarView(const Bar* ring, size_t ringCapacity, size_t oldest, size_t size)
+        : data(ring), capacity(ringCapacity), head(oldest), count(size) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const Bar& operator[](size_t i) const {
+        size_t slot = head + i;
+        return data[slot >= capacity ? slot - capacity : slot];
+    }
+    const Bar& front() const { return (*this)[0]; }
+    const Bar& back() const { return (*this)[count - 1]; }
+
+    // bars[size() - 1 - n]: 0 is the latest completed bar
+    const Bar& ago(size_t n) const { return (*this)[count - 1 - n]; }
+
+    // The two contiguous runs that make up the view, for tight loops
+    const Bar* firstSegment() const { return data + head; }
+    size_t firstSegmentSize() const { return count < capacity - head ? count : capacity - head; }
+    const Bar* secondSegment() const { return data; }
+    size_t secondSegmentSize() const { return count - firstSegmentSize(); }
+};
+
+class BarSeries {
+private:
+    size_t ticksPerBar;
+    size_t capacity;
+
+    // Completed bars: a ring of 'capacity' per symbol (symbol i occupies [i*capacity, (i+1)*capacity))
+    std::vector<Bar> ring;
+    std::vector<size_t> heads;
+    std::vector<size_t> counts;
+    std::vector<uint64_t> completed;    // bars ever completed
+    std::vector<Bar> forming;
+
+public:
+    BarSeries(size_t updatesPerBar, size_t barCapacity);
+
+    size_t getTicksPerBar() const { return ticksPerBar; }
+    size_t getCapacity() const { return capacity; }
+    size_t getSymbolCount() const { return forming.size(); }
+
+    // Grow the columns by one symbol; returns its index
+    size_t addSymbol();
+
+    // 'sequence' is the symbol's price update number, starting at 0
+    void update(size_t index, uint64_t sequence, double price, double volume);
+
+    BarView getBars(size_t index) const;
+
+    // The bar still being built (ticks == 0 right after a bar completes)
+    const Bar& getFormingBar(size_t index) const { return forming[index]; }
+
+    // Grows by one whenever a bar completes, so strategies can detect new bars
+    uint64_t getCompletedCount(size_t index) const { return completed[index]; }
+
+private:
+    void publish(size_t index);
+};
+
+#endif // BAR_SERIES_H
@@ -0,0 +1,131 @@
+// ColumnarFile.h
+// Streaming columnar file format for simulation output. Rows are buffered
+// per column and cut into chunks; full chunks are encoded and written by a
+// background thread, so the producer only appends to vectors.
+//
+// Layout (all integers LEB128 varints unless noted):
+//   "TCOL0002"                            8-byte magic
+//   columnCount, { nameLength, name, type:u8 }...
+//   chunks: rowCount, { encoding:u8, byteLength, payload }... per column
+//   end marker: rowCount 0, then totalRows
+// Column encodings:
+//   INT64  - first value then successive deltas, zigzag-encoded
+//   DOUBLE - mode:u8 (the smaller of the two is written), then either
+//            1 + d: every value in the chunk is exactly n / 10^d (d <= 6),
+//                   e.g. tick-rounded prices; n stored like INT64
+//            0:     Gorilla-style bit stream (MSB first, padded to a byte):
+//                   the first value's 64 bits, then per value the XOR with
+//                   the previous one as '0' (unchanged), '10' + the
+//                   meaningful bits inside the previous leading/trailing-zero
+//                   window, or '11' + leading zeros (5 bits) + meaningful
+//                   length - 1 (6 bits) + the meaningful bits
+//            "TCOL0001" files (XOR as a varint, no mode) are still readable.
+//   STRING - dictionary shared across the file: the chunk carries only the
+//            new entries, then (code, runLength) pairs
+#ifndef COLUMNAR_FILE_H
+#define COLUMNAR_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+enum class ColumnType : uint8_t {
+    INT64 = 1,
+    DOUBLE = 2,
+    STRING = 3
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+};
+
+class ColumnarWriter {
+private:
+    struct ColumnBuffer {
+        std::vector<int64_t> ints;          // INT64 values or STRING codes
+        std::vector<double> doubles;
+        std::vector<std::string> newEntries; // dictionary entries first used in this chunk
+    };
+
+    struct Chunk {
+        size_t rows = 0;
+        std::vector<ColumnBuffer> columns;
+    };
+
+    std::vector<ColumnSpec> schema;
+    size_t chunkRows;
+    std::FILE* file;
+
+    // Producer side
+    Chunk current;
+    std::vector<std::unordered_map<std::string, int64_t>> dictionaries;
+    uint64_t totalRows;
+
+    // Background writer
+    std::thread writerThread;
+    std::mutex mutex;
+    std::condition_variable pendingCondition;
+    std::condition_variable spaceCondition;
+    std::deque<Chunk> pending;
+    std::vector<Chunk> freeChunks;
+    size_t maxPendingChunks;
+    std::atomic<size_t> pendingCount;   // pending.size(), readable without the lock
+    bool closing;
+    std::vector<uint8_t> encodeBuffer;
+    std::vector<uint8_t> columnBuffer;
+
+public:
+    ColumnarWriter(const std::string& path, const std::vector<ColumnSpec>& schema, size_t chunkRows = 65536);
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    const std::vector<ColumnSpec>& getSchema() const { return schema; }
+    uint64_t getRowCount() const { return totalRows; }
+    // Chunks waiting for the writer thread; safe to read from any thread
+    size_t getPendingChunks() const { return pendingCount.load(std::memory_order_relaxed); }
+
+    // Fill one value per column, then endRow(). Values must match the column type.
+    void appendInt(size_t column, int64_t value) { current.columns[column].ints.push_back(value); }
+    void appendDouble(size_t column, double value) { current.columns[column].doubles.push_back(value); }
+    void appendString(size_t column, const std::string& value);
+    void endRow();
+
+    // Hand the partial chunk to the writer thread
+    void flush();
+    // Flush, write the end marker and join the writer thread
+    void close();
+
+private:
+    Chunk takeFreeChunk();
+    void enqueue(Chunk&& chunk);
+    void writerLoop();
+    void encodeChunk(const Chunk& chunk);
+};
+
+// Decoded column, for tools and round-trip checks
+struct ColumnData {
+    std::string name;
+    ColumnType type;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string> strings;
+};
+
+class ColumnarReader {
+public:
+    // Decode a whole file; returns false on a malformed or truncated file
+    static bool readFile(const std::string& path, std::vector<ColumnData>& columns);
+};
+
+#endif // COLUMNAR_FILE_H
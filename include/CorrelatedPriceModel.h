@@ -0,0 +1,80 @@
+// CorrelatedPriceModel.h
+// Correlated shock generator for multi-asset price simulation. Produces one
+// unit-variance shock per symbol per tick, either from the Cholesky factor of
+// a correlation matrix or from a linear factor model, with optional Merton
+// jumps and Markov regime switching of volatility. Market scales the shocks
+// by each symbol's own volatility in its GBM step.
+#ifndef CORRELATED_PRICE_MODEL_H
+#define CORRELATED_PRICE_MODEL_H
+
+#include <cstddef>
+#include <vector>
+#include <random>
+
+class CorrelatedPriceModel {
+public:
+    enum class Mode {
+        INDEPENDENT,
+        CHOLESKY,
+        FACTOR
+    };
+
+private:
+    size_t numSymbols;
+    Mode mode;
+
+    // CHOLESKY: lower-triangular factor, row-major n x n
+    std::vector<double> lower;
+
+    // FACTOR: loadings n x k (row-major) and idiosyncratic scale per symbol
+    size_t numFactors;
+    std::vector<double> loadings;
+    std::vector<double> idiosyncratic;
+
+    // Jumps (Merton): annual intensity, log-jump mean and stddev
+    double jumpIntensity;
+    double jumpMean;
+    double jumpVolatility;
+
+    // Regime switching: volatility multiplier per regime, row-stochastic transitions
+    std::vector<double> regimeVolMultiplier;
+    std::vector<double> regimeTransition;
+    size_t currentRegime;
+
+    // Scratch
+    std::vector<double> draws;
+    std::normal_distribution<double> normalDist;
+    std::uniform_real_distribution<double> uniformDist;
+
+public:
+    explicit CorrelatedPriceModel(size_t symbolCount = 0);
+
+    size_t getSymbolCount() const { return numSymbols; }
+    Mode getMode() const { return mode; }
+    bool isActive() const;
+
+    // Configuration. Matrices are row-major and ordered by Market symbol index.
+    bool setCorrelationMatrix(const std::vector<double>& correlation);
+    bool setFactorModel(const std::vector<double>& factorLoadings, size_t factorCount);
+    void setJumpModel(double intensity, double meanLogJump, double logJumpVolatility);
+    bool setRegimeSwitching(const std::vector<double>& volMultipliers, const std::vector<double>& transition);
+
+    // Regime state
+    size_t getRegime() const { return currentRegime; }
+    double getVolMultiplier() const;
+
+    // Draw one tick: unit-variance correlated shocks and additive log-jumps
+    // (both resized to getSymbolCount()). dt is the step length in years.
+    void generate(std::mt19937& rng, double dt, std::vector<double>& shocks, std::vector<double>& jumps);
+
+    // In-place-safe Cholesky factorization of a symmetric positive-definite matrix
+    static bool choleskyDecompose(const std::vector<double>& matrix, size_t n, std::vector<double>& result);
+
+    // y = L * x for a row-major lower-triangular L, cache-blocked
+    static void lowerTriangularMultiply(const std::vector<double>& L, size_t n, const double* x, double* y);
+
+private:
+    void advanceRegime(std::mt19937& rng);
+};
+
+#endif // CORRELATED_PRICE_MODEL_H
@@ -0,0 +1,52 @@
+// CrossSectionalSignals.h
+// Columnar per-tick market snapshot and vectorized cross-sectional operations
+// for strategies that rank or normalize a whole universe at once.
+#ifndef CROSS_SECTIONAL_SIGNALS_H
+#define CROSS_SECTIONAL_SIGNALS_H
+
+#include <cstddef>
+#include <vector>
+
+// One entry per symbol, ordered by Market symbol index (see Market::getSymbolsByIndex).
+// Returns are simple one-step returns expressed as fractions, not percent.
+struct MarketSnapshot {
+    std::vector<double> prices;
+    std::vector<double> returns;
+    std::vector<double> volatilities;
+    std::vector<int> sectors;
+    long step = 0;
+
+    size_t size() const { return prices.size(); }
+};
+
+// Operations reuse internal scratch buffers, so one instance per strategy
+// keeps steady-state signal computation allocation-free.
+class CrossSectionalSignals
+{
+public:
+    // Normalized ranks in [0, 1]; ties receive their average rank
+    void rank(const std::vector<double> &values, std::vector<double> &out);
+
+    // (x - mean) / stddev; all zeros when the cross-section has no dispersion
+    void zscore(const std::vector<double> &values, std::vector<double> &out) const;
+
+    // Subtract the cross-sectional mean
+    void demean(const std::vector<double> &values, std::vector<double> &out) const;
+
+    // Subtract each sector's mean so the signal is neutral within every sector
+    void sectorNeutralize(const std::vector<double> &values, const std::vector<int> &sectors,
+                          std::vector<double> &out);
+
+    // Indices of the k largest / smallest values, best first (O(n + k log k))
+    void topK(const std::vector<double> &values, size_t k, std::vector<size_t> &out);
+    void bottomK(const std::vector<double> &values, size_t k, std::vector<size_t> &out);
+
+private:
+    std::vector<size_t> order;
+    std::vector<double> sectorSum;
+    std::vector<double> sectorCount;
+
+    void selectK(const std::vector<double> &values, size_t k, bool largest, std::vector<size_t> &out);
+};
+
+#endif // CROSS_SECTIONAL_SIGNALS_H
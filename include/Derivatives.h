@@ -0,0 +1,233 @@
+// Derivatives.h
+// Options and futures on Market symbols, revalued every tick. Contracts are
+// kept per underlying as structure-of-arrays (OptionChain, FuturesCurve), and
+// a chain's Black-Scholes prices and Greeks come from one branch-free loop
+// over those arrays that the compiler vectorizes: exp, log and the normal CDF
+// are inlined polynomial approximations rather than libm calls, so a chain
+// costs a few tens of nanoseconds per contract per tick. MonteCarloPricer
+// prices a chain off paths drawn with the Market's own GBM step.
+// DerivativesBook holds the contracts and positions and keeps portfolio
+// Greeks up to date incrementally, per underlying.
+#ifndef DERIVATIVES_H
+#define DERIVATIVES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+class Market;
+
+enum class OptionRight : uint8_t {
+    CALL,
+    PUT
+};
+
+// Market steps are trading days (see Market::updatePrices)
+constexpr double YEARS_PER_STEP = 1.0 / 252.0;
+
+// Sensitivities of one contract unit, or position-weighted sums over many
+// (value is then the mark-to-market value). Vega and rho are per 1.00 change
+// in volatility / rate, theta per year.
+struct Greeks {
+    double value = 0.0;
+    double delta = 0.0;
+    double gamma = 0.0;
+    double vega = 0.0;
+    double theta = 0.0;
+    double rho = 0.0;
+
+    Greeks& operator+=(const Greeks& other);
+    Greeks& operator-=(const Greeks& other);
+};
+
+// Single-contract Black-Scholes with libm functions, for spot checks and
+// one-off quotes. Expired contracts are worth their intrinsic value.
+Greeks blackScholes(OptionRight right, double spot, double strike, double years, double vol, double rate);
+
+// European options on one underlying. Expiries are Market steps. On the
+// first revalue at or after its expiry a contract settles: its payoff is
+// fixed at that spot, the position is paid out and closed, and its price and
+// Greeks no longer follow the underlying.
+class OptionChain {
+private:
+    // Contract terms, one entry per contract
+    std::vector<double> strikes;
+    std::vector<double> expiries;
+    std::vector<double> callFlags;      // 1 for calls, 0 for puts
+    std::vector<double> impliedVols;    // <= 0: price with the underlying's volatility
+    std::vector<double> multipliers;
+    std::vector<double> positions;
+
+    // Outputs of the last revalue, per contract unit
+    std::vector<double> prices;
+    std::vector<double> deltas;
+    std::vector<double> gammas;
+    std::vector<double> vegas;
+    std::vector<double> thetas;
+    std::vector<double> rhos;
+    std::vector<uint8_t> settled;
+    std::vector<double> settlementPrices;
+    size_t settledCount = 0;
+    long nextExpiry = std::numeric_limits<long>::max();     // earliest unsettled expiry
+    Greeks totals;
+
+public:
+    size_t addOption(OptionRight right, double strike, long expiryStep, double multiplier = 100.0,
+                     double impliedVol = 0.0);
+    size_t size() const { return strikes.size(); }
+
+    // Reprice every contract (one vectorized pass) and re-sum the totals.
+    // Returns the payout of contracts that settled, positive to the holder.
+    double revalue(double spot, double vol, double rate, long step);
+
+    // Changes the totals by the position change only; settled contracts no longer trade
+    void setPosition(size_t index, double quantity);
+    bool isSettled(size_t index) const { return settled[index] != 0; }
+    double getPosition(size_t index) const { return positions[index]; }
+
+    Greeks getGreeks(size_t index) const;
+    const Greeks& getTotals() const { return totals; }
+    double getPrice(size_t index) const { return prices[index]; }
+    double getStrike(size_t index) const { return strikes[index]; }
+    long getExpiryStep(size_t index) const { return static_cast<long>(expiries[index]); }
+    OptionRight getRight(size_t index) const { return callFlags[index] != 0.0 ? OptionRight::CALL : OptionRight::PUT; }
+    double getImpliedVol(size_t index) const { return impliedVols[index]; }
+
+private:
+    double settleExpired(long step);
+};
+
+// Futures on one underlying, marked at cost of carry (spot * e^(rT)).
+// Positions are settled to every new mark, so they carry no value between
+// marks: revalue returns the variation margin owed to the holder. The first
+// revalue at or after expiry pays the final margin and closes the position.
+class FuturesCurve {
+private:
+    std::vector<double> expiries;
+    std::vector<double> multipliers;
+    std::vector<double> positions;
+    std::vector<double> costBasis;      // position * multiplier * last settled mark
+    std::vector<double> marks;
+    std::vector<double> deltas;
+    std::vector<double> rhos;
+    std::vector<uint8_t> settled;
+    Greeks totals;
+
+public:
+    size_t addFuture(long expiryStep, double multiplier = 1.0);
+    size_t size() const { return expiries.size(); }
+
+    double revalue(double spot, double rate, long step);
+
+    // Trades the difference at the current mark; settled contracts no longer trade
+    void setPosition(size_t index, double quantity);
+    bool isSettled(size_t index) const { return settled[index] != 0; }
+    double getPosition(size_t index) const { return positions[index]; }
+
+    Greeks getGreeks(size_t index) const;
+    const Greeks& getTotals() const { return totals; }
+    double getMark(size_t index) const { return marks[index]; }
+    long getExpiryStep(size_t index) const { return static_cast<long>(expiries[index]); }
+};
+
+// European prices by simulation. Paths are stepped with GbmStep::applyShocks,
+// the update Market and SimulationLoop use, under the risk-neutral drift, so
+// prices converge to the market's own discretized model. One set of paths
+// serves every strike and expiry in the chain: contracts are settled as the
+// paths pass their expiry step. All contracts use the underlying's volatility.
+class MonteCarloPricer {
+private:
+    size_t pathCount;
+    bool antithetic;
+    std::mt19937 rng;
+    std::normal_distribution<double> normalDist;
+    std::vector<double> paths;
+    std::vector<double> returns;
+    std::vector<double> shocks;
+    std::vector<double> vols;
+    std::vector<size_t> byExpiry;
+
+public:
+    explicit MonteCarloPricer(size_t paths = 20000, unsigned int seed = 42, bool antitheticVariates = true);
+
+    // Prices (and optionally standard errors) per contract unit, indexed like the chain
+    void price(const OptionChain& chain, double spot, double vol, double rate, long step,
+               std::vector<double>& out, std::vector<double>* standardErrors = nullptr);
+};
+
+// Contracts and positions across underlyings. Contract ids are assigned in
+// creation order. Totals are kept per underlying; revaluing or trading one
+// underlying adjusts the book totals by that underlying's change only.
+// Option premiums, futures variation margin and expiry payouts accumulate as a cash flow
+// until takeCashFlow collects it; the TradingEngine settles it into the
+// Portfolio's base-currency cash from markToMarket.
+class DerivativesBook {
+private:
+    struct Underlying {
+        std::string symbol;
+        OptionChain options;
+        FuturesCurve futures;
+        Greeks totals;
+        double lastSpot = -1.0;
+        double lastVol = -1.0;
+        long lastStep = -1;
+    };
+    struct ContractRef {
+        uint32_t underlying;
+        uint32_t index;
+        bool future;
+    };
+
+    std::vector<Underlying> underlyings;
+    std::map<std::string, size_t> underlyingIndex;
+    std::vector<ContractRef> contracts;
+    double riskFreeRate;
+    Greeks totals;
+    double cashFlow;    // uncollected premiums and variation margin, positive when received
+
+public:
+    explicit DerivativesBook(double rate = 0.0) : riskFreeRate(rate), cashFlow(0.0) {}
+
+    size_t addOption(const std::string& underlying, OptionRight right, double strike, long expiryStep,
+                     double multiplier = 100.0, double impliedVol = 0.0);
+    size_t addFuture(const std::string& underlying, long expiryStep, double multiplier = 1.0);
+    size_t getContractCount() const { return contracts.size(); }
+
+    // Options trade at their current price, paying or receiving the premium;
+    // futures trade at the current mark. Revalue before the first trade.
+    void setPosition(size_t contract, double quantity);
+    double getPosition(size_t contract) const;
+    // True once the contract has expired and been paid out
+    bool isSettled(size_t contract) const;
+
+    // Reprice every underlying whose price, volatility or step moved since
+    // its last revaluation. The TradingEngine calls this from markToMarket.
+    void revalue(const Market& market);
+
+    // Returns the cash flow since the last call and resets it
+    double takeCashFlow();
+    double getCashFlow() const { return cashFlow; }
+
+    void setRiskFreeRate(double rate);
+    double getRiskFreeRate() const { return riskFreeRate; }
+
+    // Per contract unit; value is the option price or futures mark
+    Greeks getContractGreeks(size_t contract) const;
+
+    // Position-weighted, including contract multipliers
+    const Greeks& getTotals() const { return totals; }
+    Greeks getUnderlyingTotals(const std::string& symbol) const;
+
+    // Direct access for pricing a whole chain, e.g. with MonteCarloPricer
+    const OptionChain* getOptionChain(const std::string& symbol) const;
+
+private:
+    Underlying& underlyingFor(const std::string& symbol);
+    void revalueUnderlying(Underlying& underlying, double spot, double vol, long step);
+};
+
+#endif // DERIVATIVES_H
@@ -0,0 +1,152 @@
+// Exchange.h
+// Multi-agent exchange mode. Agents, each with its own Portfolio, send limit
+// and immediate-or-cancel orders to a shared continuous double-auction book
+// per symbol. Prices come from matches rather than the exogenous price model;
+// every step the last trade is published to the Market so the usual rolling
+// statistics and snapshots keep working.
+#ifndef EXCHANGE_H
+#define EXCHANGE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <random>
+#include "Market.h"
+#include "Portfolio.h"
+#include "FeeModel.h"
+#include "LimitOrderBook.h"
+
+class Exchange;
+
+struct ExchangeFill {
+    size_t symbolId;
+    uint64_t orderId;
+    OrderType side;
+    Ticks price;
+    Lots lots;
+    LiquidityFlag liquidity;
+};
+
+class ExchangeAgent {
+private:
+    std::string name;
+    uint32_t agentId;
+    Portfolio portfolio;
+
+    friend class Exchange;
+
+public:
+    ExchangeAgent(const std::string& name, double initialCash);
+    virtual ~ExchangeAgent() = default;
+
+    // Called once per exchange step, in a freshly shuffled agent order
+    virtual void onStep(Exchange& exchange, std::mt19937& rng) = 0;
+
+    // Called after the fill has been settled. Must not submit or cancel orders.
+    virtual void onFill(const ExchangeFill& fill) { (void)fill; }
+
+    const std::string& getName() const { return name; }
+    uint32_t getAgentId() const { return agentId; }
+    Portfolio& getPortfolio() { return portfolio; }
+    const Portfolio& getPortfolio() const { return portfolio; }
+};
+
+class Exchange {
+private:
+    struct Listing {
+        std::string symbol;
+        Instrument instrument;
+        LimitOrderBook book;
+        Ticks referencePrice;   // used until the first trade
+        double stepVolume;
+    };
+
+    // Pre-trade risk: cash and position already committed to live orders
+    struct Account {
+        std::map<std::string, Money> reservedCash;
+        std::vector<Lots> reservedSellLots;     // by symbol id
+    };
+
+    struct OpenOrder {
+        uint32_t agentId;
+        size_t symbolId;
+        OrderType side;
+        Lots lots;
+        Money reservedCash;
+    };
+
+    Market& market;
+    std::vector<Listing> listings;
+    std::map<std::string, size_t> symbolIds;
+    std::vector<std::unique_ptr<ExchangeAgent>> agents;
+    std::vector<Account> accounts;
+    std::vector<size_t> agentOrder;
+    std::unordered_map<uint64_t, OpenOrder> openOrders;
+    std::vector<Trade> tradeScratch;
+    FeeModel feeModel;
+    std::mt19937 randomGenerator;
+    uint64_t nextOrderId;
+    long currentStep;
+
+    // Statistics
+    uint64_t messageCount;
+    uint64_t rejectedCount;
+    uint64_t tradeCount;
+    uint64_t failedSettlements;
+    double tradedVolume;
+    double elapsedSeconds;
+
+public:
+    explicit Exchange(Market& market, unsigned int seed = 42);
+
+    // Listing a symbol also adds it to the Market if it is not there yet
+    size_t listSymbol(const std::string& symbol, double referencePrice, double tickSize = 0.01,
+                      double lotSize = 1.0, const std::string& currency = "USD");
+    ExchangeAgent& addAgent(std::unique_ptr<ExchangeAgent> agent);
+
+    // Order entry. Buys reserve notional plus the larger of the maker and
+    // taker fee at the limit price, sells reserve position unless the agent
+    // may short. Returns the order id, or 0 when the order is rejected. IOC
+    // orders never rest. A trade settles both legs or, if either agent cannot
+    // pay for its side, neither (counted in getFailedSettlements).
+    uint64_t submitOrder(ExchangeAgent& agent, size_t symbolId, OrderType side, Lots lots, Ticks limitPrice,
+                         TimeInForce timeInForce = TimeInForce::GTC);
+    bool cancelOrder(ExchangeAgent& agent, uint64_t orderId);
+
+    // Simulation
+    void step();
+    void run(int steps);
+
+    // Configuration
+    void setFeeModel(const FeeModel& model) { feeModel = model; }
+    const FeeModel& getFeeModel() const { return feeModel; }
+
+    // Queries for agents and reporting
+    size_t getSymbolCount() const { return listings.size(); }
+    size_t getSymbolId(const std::string& symbol) const;
+    const std::string& getSymbol(size_t symbolId) const { return listings[symbolId].symbol; }
+    const Instrument& getInstrument(size_t symbolId) const { return listings[symbolId].instrument; }
+    const LimitOrderBook& getBook(size_t symbolId) const { return listings[symbolId].book; }
+    Ticks getReferencePrice(size_t symbolId) const;   // mid, else last trade, else listing price
+    Market& getMarket() { return market; }
+    long getCurrentStep() const { return currentStep; }
+    size_t getAgentCount() const { return agents.size(); }
+    const ExchangeAgent& getAgent(size_t index) const { return *agents[index]; }
+
+    uint64_t getMessageCount() const { return messageCount; }
+    uint64_t getTradeCount() const { return tradeCount; }
+    uint64_t getFailedSettlements() const { return failedSettlements; }
+    double getTradedVolume() const { return tradedVolume; }
+    double getMessagesPerSecond() const { return elapsedSeconds > 0.0 ? messageCount / elapsedSeconds : 0.0; }
+    void printSummary() const;
+
+private:
+    void settle(Listing& listing, size_t symbolId, const Trade& trade);
+    void consumeReservation(const Listing& listing, size_t symbolId, uint64_t orderId, uint32_t agentId,
+                            OrderType side, Lots lots);
+    void releaseOrder(std::unordered_map<uint64_t, OpenOrder>::iterator it);
+};
+
+#endif // EXCHANGE_H
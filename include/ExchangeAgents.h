@@ -0,0 +1,60 @@
+// ExchangeAgents.h
+// Stock agent populations for the Exchange: uninformed noise traders,
+// inventory-aware market makers and a momentum strategy that trades on the
+// Market's rolling statistics of exchange prices.
+#ifndef EXCHANGE_AGENTS_H
+#define EXCHANGE_AGENTS_H
+
+#include <deque>
+#include <utility>
+#include "Exchange.h"
+
+class NoiseTrader : public ExchangeAgent {
+private:
+    double arrivalProbability;      // per symbol and step
+    double marketableProbability;   // share of arrivals that cross the spread
+    Lots maxLots;
+    Ticks maxOffset;                // limit distance from the reference price
+    size_t maxOpenOrders;           // oldest orders are cancelled beyond this
+    std::deque<std::pair<size_t, uint64_t>> openOrders;
+
+public:
+    NoiseTrader(const std::string& name, double initialCash, double arrivalProbability = 0.5,
+                double marketableProbability = 0.3, Lots maxLots = 10, Ticks maxOffset = 10,
+                size_t maxOpenOrders = 20);
+
+    void onStep(Exchange& exchange, std::mt19937& rng) override;
+};
+
+class MarketMaker : public ExchangeAgent {
+private:
+    Ticks halfSpread;
+    Lots quoteLots;
+    Lots maxInventory;
+    std::vector<uint64_t> bidIds;   // by symbol id, 0 when not quoting
+    std::vector<uint64_t> askIds;
+
+public:
+    MarketMaker(const std::string& name, double initialCash, Ticks halfSpread = 2, Lots quoteLots = 20,
+                Lots maxInventory = 200);
+
+    // Cancels and re-quotes both sides every step, skewed against inventory
+    void onStep(Exchange& exchange, std::mt19937& rng) override;
+};
+
+class MomentumAgent : public ExchangeAgent {
+private:
+    size_t window;
+    double threshold;   // fractional distance from the SMA that triggers a trade
+    Lots tradeLots;
+    bool windowRegistered;
+
+public:
+    MomentumAgent(const std::string& name, double initialCash, size_t window = 20, double threshold = 0.002,
+                  Lots tradeLots = 10);
+
+    // Long-only: buys above the moving average, exits below it
+    void onStep(Exchange& exchange, std::mt19937& rng) override;
+};
+
+#endif // EXCHANGE_AGENTS_H
@@ -0,0 +1,67 @@
+// FeeModel.h
+// Transaction cost schedule applied by the TradingEngine on every fill.
+// Components add up: a flat per-order fee, a per-share fee, an ad-valorem
+// rate in basis points, maker/taker rates and a volume-tiered rate.
+#ifndef FEE_MODEL_H
+#define FEE_MODEL_H
+
+#include <cstddef>
+#include <vector>
+
+enum class LiquidityFlag {
+    MAKER,
+    TAKER
+};
+
+struct FeeTier {
+    double volumeThreshold; // cumulative traded quantity at which the tier starts
+    double basisPoints;
+};
+
+class FeeModel {
+private:
+    double perOrderFee;
+    double perShareFee;
+    double basisPoints;
+    double makerBasisPoints;
+    double takerBasisPoints;
+    double minimumFee;
+
+    // Tier table, flattened at configuration time. Cumulative volume only
+    // grows, so the active tier is advanced incrementally instead of searched.
+    std::vector<double> tierThresholds;
+    std::vector<double> tierBasisPoints;
+    size_t currentTier;
+    double cumulativeVolume;
+
+public:
+    explicit FeeModel(double perOrder = 0.0);
+
+    // Configuration
+    void setPerOrderFee(double fee) { perOrderFee = fee; }
+    void setPerShareFee(double fee) { perShareFee = fee; }
+    void setBasisPoints(double bps) { basisPoints = bps; }
+    void setMakerTakerBasisPoints(double makerBps, double takerBps);
+    void setMinimumFee(double fee) { minimumFee = fee; }
+    void setVolumeTiers(std::vector<FeeTier> tiers);
+
+    double getPerOrderFee() const { return perOrderFee; }
+    double getCumulativeVolume() const { return cumulativeVolume; }
+
+    // Fee for a fill at the current tier. Maker rebates (negative rates) are allowed.
+    double computeFee(double quantity, double price, LiquidityFlag liquidity) const {
+        double notional = quantity * price;
+        double rateBps = basisPoints + (liquidity == LiquidityFlag::MAKER ? makerBasisPoints : takerBasisPoints);
+        if (!tierBasisPoints.empty()) {
+            rateBps += tierBasisPoints[currentTier];
+        }
+        double fee = perOrderFee + perShareFee * quantity + notional * rateBps * 1e-4;
+        return (fee < minimumFee && fee > 0.0) ? minimumFee : fee;
+    }
+
+    // Account a filled quantity towards the volume tiers (the first tier applies from zero)
+    void recordVolume(double quantity);
+    void resetVolume();
+};
+
+#endif // FEE_MODEL_H
@@ -10,6 +10,7 @@
 class Market;
 class Portfolio;
 class TradingEngine;
+struct MarginEvent;
 
 class IStrategy
 {
@@ -27,7 +28,10 @@ public:
     virtual void onTick(Market &market, Portfolio &portfolio, TradingEngine &engine, int step) = 0;
 
     // Optional callback for order executions
-    virtual void onOrderExecuted(const Order &order) {}
+    virtual void onOrderExecuted(const Order &/*order*/) {}
+
+    // Optional callback for margin calls and liquidations of the account
+    virtual void onMarginEvent(const MarginEvent &/*event*/) {}
 
     // Human-readable strategy name
     virtual std::string name() const = 0;
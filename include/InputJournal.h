@@ -0,0 +1,103 @@
+// InputJournal.h
+// Append-only binary journal of everything that drives a TradingEngine:
+// order-entry calls (submitOrder, executeMarketOrder, cancelOrder), clock
+// steps (processOrders) and market ticks (markToMarket, called by
+// runSimulation after every price update). Attach one with
+// TradingEngine::setJournal. Records are buffered and written in batches; the
+// file is fsync'ed every syncInterval records and on flush/close.
+//
+// JournalReplayer feeds a journal into a fresh engine at full speed. Strategy
+// decisions are already in the journal as calls, so strategies need not be
+// registered; the engine must be configured like the recorded one (initial
+// cash, fee model, latency and sharding settings).
+//
+// Layout: "TJNL0001", then records of a one-byte JournalRecord type and its
+// fields in host byte order. Strings are a uint32 length and the bytes.
+#ifndef INPUT_JOURNAL_H
+#define INPUT_JOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Order.h"
+
+class Market;
+class TradingEngine;
+struct MarketSnapshot;
+
+enum class JournalRecord : uint8_t {
+    SYMBOLS = 1,    // uint32 count, then name, price, volatility per symbol
+    TICK,           // int64 step, uint32 count, prices by symbol index
+    SUBMIT,         // call context, then the order as submitted
+    MARKET_ORDER,   // call context, int32 order id, symbol, side, quantity
+    CANCEL,         // call context, int32 order id
+    PROCESS         // no fields
+};
+
+class InputJournal {
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t bufferLimit;
+    size_t syncInterval;
+    size_t unsyncedRecords;
+    uint64_t recordCount;
+
+public:
+    explicit InputJournal(const std::string& path, size_t syncInterval = 4096, size_t bufferBytes = 1 << 16);
+    ~InputJournal();
+
+    InputJournal(const InputJournal&) = delete;
+    InputJournal& operator=(const InputJournal&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t getRecordCount() const { return recordCount; }
+
+    // Call context is the engine's active strategy and the market's quote
+    // delay at the time of the call, both of which change what a call does
+    void recordSymbols(const Market& market);
+    void recordTick(long step, const MarketSnapshot& snapshot);
+    void recordSubmit(const std::string& activeStrategy, size_t quoteDelay, const Order& order);
+    void recordMarketOrder(const std::string& activeStrategy, size_t quoteDelay, int orderId,
+                           const std::string& symbol, OrderType type, double quantity);
+    void recordCancel(const std::string& activeStrategy, size_t quoteDelay, int orderId);
+    void recordProcess();
+
+    // Write buffered records and fsync
+    void flush();
+    void close();
+
+private:
+    template <typename T>
+    void put(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+    void putString(const std::string& value);
+    void beginRecord(JournalRecord type);
+    void putContext(const std::string& activeStrategy, size_t quoteDelay);
+    void endRecord();
+    void writeBuffer();
+};
+
+struct ReplayResult {
+    bool ok = false;
+    bool truncated = false;     // the journal ended inside a record (e.g. after a crash)
+    std::string error;
+    uint64_t records = 0;
+    uint64_t ticks = 0;
+    uint64_t calls = 0;         // order-entry and processOrders calls
+    double seconds = 0.0;
+};
+
+class JournalReplayer {
+public:
+    // Drive 'engine' and the Market it trades on through the journal.
+    // Recorded symbols missing from the market are added first. Orders get
+    // their recorded ids; the order id counter is left past both those and
+    // any id handed out before the replay.
+    static ReplayResult replay(const std::string& path, Market& market, TradingEngine& engine);
+};
+
+#endif // INPUT_JOURNAL_H
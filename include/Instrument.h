@@ -0,0 +1,49 @@
+// Instrument.h
+// Contract specification and fixed-point representation used for exact
+// portfolio accounting. Prices are held as integer ticks, quantities as
+// integer lots and cash as integer money units of 1e-8 currency units.
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+using Ticks = int64_t;
+using Lots = int64_t;
+using Money = int64_t;
+
+constexpr Money MONEY_SCALE = 100000000;
+
+inline Money toMoney(double amount) { return static_cast<Money>(std::llround(amount * MONEY_SCALE)); }
+inline double fromMoney(Money amount) { return static_cast<double>(amount) / MONEY_SCALE; }
+
+struct Instrument {
+    std::string symbol;
+    double tickSize;
+    double lotSize;
+    std::string currency;
+    double borrowRate;      // annual rate charged on short market value
+    Money moneyPerTickLot;  // value of one tick on one lot
+
+    Instrument(const std::string& sym = "", double tick = 0.01, double lot = 1.0,
+               const std::string& ccy = "USD", double borrow = 0.0)
+        : symbol(sym), tickSize(tick), lotSize(lot), currency(ccy), borrowRate(borrow),
+          moneyPerTickLot(std::max<Money>(1, toMoney(tick * lot))) {}
+
+    Ticks toTicks(double price) const { return static_cast<Ticks>(std::llround(price / tickSize)); }
+    Lots toLots(double quantity) const { return static_cast<Lots>(std::llround(quantity / lotSize)); }
+    double fromTicks(Ticks ticks) const { return static_cast<double>(ticks) * tickSize; }
+    double fromLots(Lots lots) const { return static_cast<double>(lots) * lotSize; }
+    // Quantities are traded in whole lots only; toLots would round the rest away
+    bool isWholeLots(double quantity) const {
+        double lots = quantity / lotSize;
+        return std::fabs(lots - std::round(lots)) <= 1e-9 * std::max(1.0, std::fabs(lots));
+    }
+
+    // Exact notional of 'lots' at 'ticks', in money units of the instrument currency
+    Money notional(Ticks ticks, Lots lots) const { return ticks * lots * moneyPerTickLot; }
+};
+
+#endif // INSTRUMENT_H
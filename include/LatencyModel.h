@@ -0,0 +1,61 @@
+// LatencyModel.h
+// Order-entry and market-data latency for the TradingEngine. A strategy's
+// orders and cancels travel as messages that take effect when they arrive,
+// some engine steps after they were sent, and its view of prices can lag the
+// market. LatencyQueue holds the messages in flight: a TimerWheel keyed by
+// arrival step over a slab of reusable message slots, so sending and
+// delivering are O(1) per message and a step only touches the messages that
+// arrive in it, however many are outstanding.
+#ifndef LATENCY_MODEL_H
+#define LATENCY_MODEL_H
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include "Order.h"
+#include "TimerWheel.h"
+
+// Delays are in engine steps
+struct LatencyProfile {
+    long orderEntryDelay = 0;   // from submission until the engine sees the message
+    long marketDataDelay = 0;   // how far the strategy's prices lag the market
+};
+
+class LatencyQueue {
+public:
+    enum class Kind {
+        SUBMIT,
+        CANCEL
+    };
+
+    struct Message {
+        Kind kind;
+        int orderId;
+        std::optional<Order> order;     // SUBMIT only
+        long sentStep;
+        long arrivalStep;
+    };
+
+private:
+    static constexpr size_t INITIAL_CAPACITY = 64;
+
+    std::vector<Message> slots;
+    std::vector<int> freeSlots;
+    TimerWheel wheel;
+    std::vector<int> arrivedSlots;
+
+public:
+    explicit LatencyQueue(size_t wheelSlots = 256);
+
+    // Arrival steps must not lie before the next step passed to collectArrived
+    void send(Kind kind, int orderId, const Order* order, long sentStep, long arrivalStep);
+
+    // Move the messages arriving at 'step' into 'arrived', in the order they
+    // were sent. Must be called for every consecutive step.
+    void collectArrived(long step, std::vector<Message>& arrived);
+
+    size_t size() const { return wheel.size(); }
+    bool empty() const { return wheel.size() == 0; }
+};
+
+#endif // LATENCY_MODEL_H
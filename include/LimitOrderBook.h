@@ -0,0 +1,90 @@
+// LimitOrderBook.h
+// Continuous double-auction book used by the Exchange. Prices are integer
+// ticks and quantities integer lots; matching is price-time priority with
+// partial fills. Cancels are lazy: the order leaves the live index at once
+// and its queue slot is skipped when matching reaches it.
+#ifndef LIMIT_ORDER_BOOK_H
+#define LIMIT_ORDER_BOOK_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include "Order.h"
+#include "Instrument.h"
+
+struct BookOrder {
+    uint64_t orderId;
+    uint32_t agentId;
+    OrderType side;
+    Ticks price;
+    Lots lots;
+};
+
+struct Trade {
+    uint64_t buyOrderId;
+    uint64_t sellOrderId;
+    uint32_t buyAgentId;
+    uint32_t sellAgentId;
+    Ticks price;        // resting order's price
+    Lots lots;
+    OrderType aggressor;
+};
+
+class LimitOrderBook {
+private:
+    struct QueueEntry {
+        uint64_t orderId;
+        uint32_t agentId;
+    };
+
+    struct Level {
+        std::deque<QueueEntry> queue;
+        Lots volume = 0;    // live lots only
+    };
+
+    struct LiveOrder {
+        OrderType side;
+        Ticks price;
+        Lots lots;
+    };
+
+    using BidLevels = std::map<Ticks, Level, std::greater<Ticks>>;
+    using AskLevels = std::map<Ticks, Level>;
+
+    BidLevels bids;
+    AskLevels asks;
+    std::unordered_map<uint64_t, LiveOrder> live;
+    Ticks lastTradePrice;
+
+public:
+    LimitOrderBook() : lastTradePrice(0) {}
+
+    // Match 'order' against the opposite side, appending to 'trades'. Any
+    // unfilled remainder rests when 'rest' is true. Returns the unfilled lots.
+    Lots submit(const BookOrder& order, bool rest, std::vector<Trade>& trades);
+
+    // Returns the lots that were still live (0 if the order is unknown or done)
+    Lots cancel(uint64_t orderId);
+
+    // Top of book; 0 when the side is empty
+    Ticks getBestBid() const { return bids.empty() ? 0 : bids.begin()->first; }
+    Ticks getBestAsk() const { return asks.empty() ? 0 : asks.begin()->first; }
+    Ticks getLastTradePrice() const { return lastTradePrice; }
+    Lots getDepth(OrderType side, Ticks price) const;
+
+    bool isLive(uint64_t orderId) const { return live.find(orderId) != live.end(); }
+    size_t getLiveOrderCount() const { return live.size(); }
+    size_t getLevelCount() const { return bids.size() + asks.size(); }
+
+private:
+    template <typename Levels>
+    Lots match(Levels& levels, const BookOrder& order, std::vector<Trade>& trades);
+
+    template <typename Levels>
+    void eraseLive(Levels& levels, uint64_t orderId, const LiveOrder& order);
+};
+
+#endif // LIMIT_ORDER_BOOK_H
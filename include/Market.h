@@ -6,6 +6,10 @@
 #include <vector>
 #include <random>
 #include <chrono>
+#include "RollingStatistics.h"
+#include "BarSeries.h"
+#include "CrossSectionalSignals.h"
+#include "CorrelatedPriceModel.h"
 
 struct PriceData {
     double price;
@@ -21,10 +25,26 @@ private:
     std::map<std::string, std::vector<PriceData>> priceHistory;
     std::map<std::string, double> currentPrices;
     std::map<std::string, double> volatility;
+    std::vector<std::string> symbols;                 // insertion order, defines symbol index
+    std::vector<std::string> sortedSymbols;           // alphabetical
+    std::map<std::string, size_t> symbolIndex;
+    std::map<size_t, RollingStatistics> rollingStats; // keyed by window length
+    std::map<size_t, BarSeries> barSeries;            // keyed by updates per bar
+    std::vector<uint64_t> priceUpdates;               // per symbol index, prices recorded so far
+    MarketSnapshot snapshot;
+    CorrelatedPriceModel priceModel;
+    std::vector<double> shockBuffer;
+    std::vector<double> jumpBuffer;
     std::mt19937 randomGenerator;
     std::normal_distribution<double> normalDist;
+    size_t quoteDelay;                        // see setQuoteDelay
+    mutable MarketSnapshot delayedSnapshot;
 
 public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t HISTORY_LENGTH = 1000;   // price points kept per symbol
+    static constexpr size_t DEFAULT_BAR_CAPACITY = 512;
+
     Market();
     
     // Market data management
@@ -32,6 +52,23 @@ public:
     void updatePrices();
     void simulatePriceMovement(const std::string& symbol);
     
+    // One price update with given prices (by symbol index) instead of drawn
+    // ones, e.g. when replaying a journal; history, snapshot and rolling
+    // statistics advance exactly as in updatePrices
+    void setPrices(const std::vector<double>& prices);
+    
+    // Endogenous prices: record a traded price (e.g. from the Exchange)
+    // instead of drawing one from the price model
+    void recordTrade(const std::string& symbol, double price, double volume);
+    
+    // Correlated simulation. The model must be sized for the current symbol
+    // set (matrices ordered by symbol index); otherwise updatePrices keeps
+    // drawing independent shocks.
+    bool setPriceModel(const CorrelatedPriceModel& model);
+    bool setCovarianceMatrix(const std::vector<double>& covariance);
+    void clearPriceModel() { priceModel = CorrelatedPriceModel(); }
+    const CorrelatedPriceModel& getPriceModel() const { return priceModel; }
+    
     // Price queries
     double getCurrentPrice(const std::string& symbol) const;
     bool hasSymbol(const std::string& symbol) const;
@@ -41,13 +78,56 @@ public:
     double getDailyReturn(const std::string& symbol) const;
     double getVolatility(const std::string& symbol) const;
     void setVolatility(const std::string& symbol, double vol);
+    void setSector(const std::string& symbol, int sector);
+    
+    // Columnar view of the latest tick for cross-sectional strategies,
+    // indexed like getSymbolsByIndex()
+    const MarketSnapshot& getSnapshot() const { return quoteDelay ? delayedView() : snapshot; }
+    
+    // Number of price updates so far
+    long getCurrentStep() const { return snapshot.step; }
+    
+    // Market-data latency: while non-zero, current price, daily return and
+    // snapshot queries answer as of 'steps' price updates ago. Rolling
+    // statistics are not delayed. The TradingEngine sets this around each
+    // strategy's onTick from its latency profile.
+    void setQuoteDelay(size_t steps);
+    size_t getQuoteDelay() const { return quoteDelay; }
+    
+    // Rolling analytics, maintained incrementally on every price update.
+    // A window must be registered before it can be queried; registering the
+    // same length twice shares one computation.
+    const RollingStatistics& registerRollingWindow(size_t window);
+    const RollingStatistics* getRollingStatistics(size_t window) const;
+    double getSMA(const std::string& symbol, size_t window) const;
+    double getEMA(const std::string& symbol, size_t window) const;
+    double getRollingVariance(const std::string& symbol, size_t window) const;
+    double getRealizedVolatility(const std::string& symbol, size_t window) const;
+    double getRollingMin(const std::string& symbol, size_t window) const;
+    double getRollingMax(const std::string& symbol, size_t window) const;
+    double getVWAP(const std::string& symbol, size_t window) const;
+    
+    // OHLCV bars, built as prices arrive. Each resolution (in price updates
+    // per bar, see BarSeries.h) keeps its last 'capacity' completed bars per
+    // symbol; registering an existing resolution returns it unchanged. New
+    // resolutions are seeded from the retained price history.
+    const BarSeries& registerBarResolution(size_t updatesPerBar, size_t capacity = DEFAULT_BAR_CAPACITY);
+    const BarSeries* getBarSeries(size_t updatesPerBar) const;
+    BarView getBars(const std::string& symbol, size_t updatesPerBar) const;
     
-    // Utility methods
-    std::vector<std::string> getAvailableSymbols() const;
+    // Utility methods. getAvailableSymbols lists symbols alphabetically;
+    // getSymbolsByIndex lists them by symbol index (the order they were
+    // added), matching the snapshot columns.
+    const std::vector<std::string>& getAvailableSymbols() const { return sortedSymbols; }
+    const std::vector<std::string>& getSymbolsByIndex() const { return symbols; }
     void printMarketSummary() const;
+    size_t getSymbolIndex(const std::string& symbol) const;
     
 private:
+    void applyPriceShock(const std::string& symbol, double shock, double logJump);
+    const RollingStatistics* findStatistics(const std::string& symbol, size_t window, size_t& index) const;
     void recordPrice(const std::string& symbol, double price, double volume = 1000.0);
+    const MarketSnapshot& delayedView() const;
 };
 
 #endif // MARKET_H
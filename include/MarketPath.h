@@ -0,0 +1,93 @@
+// MarketPath.h
+// A price path generated or replayed once and kept as flat row-major arrays
+// ([step][symbol]), together with the per-step returns strategies consume.
+// PathReplay steps through a window of it as a SimulationLoop price model, so
+// evaluating many parameter sets against the same window only costs the
+// strategy logic, not regenerating prices.
+#ifndef MARKET_PATH_H
+#define MARKET_PATH_H
+
+#include <cstddef>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "SimulationLoop.h"
+
+class Market;
+
+class MarketPath {
+private:
+    size_t symbolCount;
+    size_t stepCount;
+    std::vector<double> prices;     // (stepCount + 1) rows; row 0 is the starting price
+    std::vector<double> returns;    // fractional return into each row; row 0 is zero
+
+public:
+    MarketPath() : symbolCount(0), stepCount(0) {}
+
+    // Draw 'steps' ticks from any SimulationLoop price model
+    template <typename PriceModel>
+    static MarketPath generate(const std::vector<double>& initialPrices, PriceModel model, int steps,
+                               std::mt19937& rng) {
+        static_assert(IsStepPriceModel<PriceModel>::value,
+                      "PriceModel must provide step(double*, double*, size_t, std::mt19937&)");
+        MarketPath path;
+        size_t count = initialPrices.size();
+        size_t rows = static_cast<size_t>(std::max(0, steps)) + 1;
+        path.symbolCount = count;
+        path.stepCount = rows - 1;
+        path.prices.resize(rows * count);
+        path.returns.assign(rows * count, 0.0);
+        std::copy(initialPrices.begin(), initialPrices.end(), path.prices.begin());
+
+        std::vector<double> current(initialPrices);
+        for (size_t step = 1; step < rows; ++step) {
+            model.step(current.data(), path.returns.data() + step * count, count, rng);
+            std::copy(current.begin(), current.end(), path.prices.begin() + step * count);
+        }
+        return path;
+    }
+
+    // Replay the recorded price history of every Market symbol (symbol index
+    // order), truncated to the shortest history
+    static MarketPath fromHistory(const Market& market);
+
+    size_t getSymbolCount() const { return symbolCount; }
+    size_t getStepCount() const { return stepCount; }
+    bool empty() const { return symbolCount == 0; }
+
+    const double* pricesAt(size_t step) const { return prices.data() + step * symbolCount; }
+    const double* returnsAt(size_t step) const { return returns.data() + step * symbolCount; }
+    std::vector<double> getPricesAt(size_t step) const {
+        return std::vector<double>(pricesAt(step), pricesAt(step) + symbolCount);
+    }
+};
+
+// SimulationLoop price model replaying a MarketPath from row 'start'. The
+// path must outlive the replay; steps past its end repeat the last row with
+// zero returns. The generator is not used.
+class PathReplay {
+private:
+    const MarketPath* path;
+    size_t cursor;
+
+public:
+    explicit PathReplay(const MarketPath* marketPath = nullptr, size_t start = 0)
+        : path(marketPath), cursor(start) {}
+
+    void step(double* prices, double* returns, size_t count, std::mt19937&) {
+        if (!path || cursor >= path->getStepCount()) {
+            std::fill(returns, returns + count, 0.0);
+            return;
+        }
+        ++cursor;
+        size_t n = std::min(count, path->getSymbolCount());
+        std::copy(path->pricesAt(cursor), path->pricesAt(cursor) + n, prices);
+        std::copy(path->returnsAt(cursor), path->returnsAt(cursor) + n, returns);
+    }
+
+    size_t getCursor() const { return cursor; }
+};
+
+#endif // MARKET_PATH_H
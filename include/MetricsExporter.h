@@ -0,0 +1,119 @@
+// MetricsExporter.h
+// Live metrics for long simulations. The TradingEngine fills an
+// EngineMetrics snapshot at the end of every step and publishes it through a
+// MetricsPublisher, a seqlock: the simulation thread only does relaxed
+// stores, never waits and never allocates, and readers retry until they copy
+// a consistent snapshot. MetricsExporter serves the latest snapshot as
+// Prometheus text (GET /metrics) on a localhost port from its own thread, so
+// a scrape never blocks the simulation.
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "ResultsWriter.h"
+
+struct EngineMetrics {
+    // Step duration histogram: upper bounds in seconds, plus an overflow bucket
+    static constexpr size_t STEP_BUCKETS = 12;
+    static constexpr double STEP_BUCKET_BOUNDS[STEP_BUCKETS] = {
+        1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 1e-2, 1e-1
+    };
+    static constexpr size_t ORDER_EVENTS = 5;   // indexed by OrderEvent
+
+    // Counters
+    uint64_t steps = 0;
+    uint64_t ordersReceived = 0;        // order-entry calls, before latency and validation
+    uint64_t orderEvents[ORDER_EVENTS] = {};
+    uint64_t fills = 0;
+    uint64_t hotPathAllocations = 0;
+
+    // Gauges
+    uint64_t restingOrders = 0;
+    uint64_t inFlightMessages = 0;      // orders and cancels inside the latency model
+    uint64_t pendingResultChunks = 0;   // chunks queued for the results writer threads
+    double equity = 0.0;
+    double cash = 0.0;
+    double totalFees = 0.0;
+
+    // Filled in by MetricsPublisher::publish
+    double stepsPerSecond = 0.0;
+    double ordersPerSecond = 0.0;
+    uint64_t stepBuckets[STEP_BUCKETS + 1] = {};  // per bucket, not cumulative
+    uint64_t stepCount = 0;
+    double stepSeconds = 0.0;
+};
+
+class MetricsPublisher {
+private:
+    static constexpr size_t WORDS = (sizeof(EngineMetrics) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Shared with readers: odd sequence while a publish is in progress
+    alignas(64) std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> words[WORDS];
+
+    // Writer side only
+    alignas(64) uint64_t stepBuckets[EngineMetrics::STEP_BUCKETS + 1];
+    uint64_t stepCount;
+    double stepSeconds;
+    std::chrono::steady_clock::time_point windowStart;
+    uint64_t windowSteps;
+    uint64_t windowOrders;
+    double stepsPerSecond;
+    double ordersPerSecond;
+    std::chrono::duration<double> rateWindow;
+
+public:
+    explicit MetricsPublisher(double rateWindowSeconds = 1.0);
+
+    MetricsPublisher(const MetricsPublisher&) = delete;
+    MetricsPublisher& operator=(const MetricsPublisher&) = delete;
+
+    // Simulation thread
+    void observeStepDuration(double seconds);
+    // Adds the rates (over the last rate window) and the step histogram, then
+    // stores the snapshot for readers
+    void publish(const EngineMetrics& metrics);
+
+    // Any thread. Returns false until the first publish.
+    bool read(EngineMetrics& out) const;
+    uint64_t getPublishCount() const { return sequence.load(std::memory_order_acquire) / 2; }
+};
+
+class MetricsExporter {
+private:
+    const MetricsPublisher& publisher;
+    uint16_t port;
+    int listenSocket;
+    std::thread serverThread;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> scrapes;
+
+public:
+    // Port 0 picks a free port; getPort() reports it after start()
+    explicit MetricsExporter(const MetricsPublisher& source, uint16_t listenPort = 9464);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Bind 127.0.0.1 and start serving; false if the socket cannot be set up
+    bool start();
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+    uint16_t getPort() const { return port; }
+    uint64_t getScrapeCount() const { return scrapes.load(std::memory_order_relaxed); }
+
+    // Prometheus text exposition format, version 0.0.4
+    static std::string render(const EngineMetrics& metrics, uint64_t publishCount);
+
+private:
+    void serve();
+    void handleConnection(int connection);
+};
+
+#endif // METRICS_EXPORTER_H
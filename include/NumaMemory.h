@@ -0,0 +1,101 @@
+// NumaMemory.h
+// Memory placement for running many simulations side by side on multi-socket
+// machines. NumaTopology reads the node/CPU layout (Linux sysfs; one node
+// elsewhere). NodeLocalResource hands out large chunks whose pages are bound
+// to one node, and SimulationArena pools them per simulation instance, so an
+// engine's order books and indexes stay on the node of the worker running it
+// instead of wherever the allocator last had free memory.
+#ifndef NUMA_MEMORY_H
+#define NUMA_MEMORY_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+class NumaTopology {
+private:
+    std::vector<std::vector<size_t>> cpusByNode;
+    std::vector<size_t> nodeIds;        // kernel node number per node index
+    std::vector<size_t> nodeByCpu;
+
+public:
+    // Detected once per process. Nodes are indexed 0..getNodeCount()-1 over
+    // the nodes that have CPUs.
+    static const NumaTopology& get();
+
+    size_t getNodeCount() const { return cpusByNode.size(); }
+    size_t getCpuCount() const { return nodeByCpu.size(); }
+    const std::vector<size_t>& getCpus(size_t node) const { return cpusByNode[node]; }
+    size_t getNodeId(size_t node) const { return nodeIds[node]; }
+    size_t getNodeOfCpu(size_t cpu) const { return cpu < nodeByCpu.size() ? nodeByCpu[cpu] : 0; }
+
+    // Node of the CPU the calling thread is running on
+    size_t getCurrentNode() const;
+
+    // Worker CPUs for 'count' threads: filled node by node ('spread' false),
+    // or round-robin across nodes ('spread' true)
+    std::vector<size_t> selectCpus(size_t count, bool spread) const;
+
+private:
+    NumaTopology();
+};
+
+// Chunks of at least 'chunkBytes' bound to one node. Allocation bumps through
+// the current chunk; memory is only returned when the resource is destroyed,
+// so it is meant as the upstream of a pool.
+class NodeLocalResource : public std::pmr::memory_resource {
+private:
+    struct Chunk {
+        void* memory;
+        size_t bytes;
+    };
+
+    size_t node;
+    size_t chunkBytes;
+    std::vector<Chunk> chunks;
+    char* cursor;
+    char* limit;
+    size_t mappedBytes;
+    bool bound;     // pages bound with mbind rather than placed by first touch
+
+public:
+    explicit NodeLocalResource(size_t numaNode, size_t chunkSize = 4 << 20);
+    ~NodeLocalResource() override;
+
+    NodeLocalResource(const NodeLocalResource&) = delete;
+    NodeLocalResource& operator=(const NodeLocalResource&) = delete;
+
+    size_t getNode() const { return node; }
+    size_t getMappedBytes() const { return mappedBytes; }
+    bool isBound() const { return bound; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    void addChunk(size_t minimumBytes);
+};
+
+// Per-instance arena: size-class pools over node-local chunks. Not thread
+// safe; one simulation instance (and the thread running it) per arena. The
+// arena must outlive everything allocated from it.
+class SimulationArena {
+private:
+    NodeLocalResource chunks;
+    std::pmr::unsynchronized_pool_resource pool;
+
+public:
+    explicit SimulationArena(size_t numaNode = NumaTopology::get().getCurrentNode(), size_t chunkSize = 4 << 20);
+
+    SimulationArena(const SimulationArena&) = delete;
+    SimulationArena& operator=(const SimulationArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &pool; }
+    size_t getNode() const { return chunks.getNode(); }
+    size_t getMappedBytes() const { return chunks.getMappedBytes(); }
+    bool isBound() const { return chunks.isBound(); }
+};
+
+#endif // NUMA_MEMORY_H
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <chrono>
+#include <atomic>
 
 enum class OrderType {
     BUY,
@@ -13,12 +14,28 @@ enum class OrderStatus {
     PENDING,
     FILLED,
     CANCELLED,
-    PARTIALLY_FILLED
+    PARTIALLY_FILLED,
+    EXPIRED
+};
+
+enum class ExecutionType {
+    MARKET,
+    LIMIT,
+    STOP,           // becomes a market order once the stop price trades
+    STOP_LIMIT,     // becomes a limit order at 'price' once the stop price trades
+    TRAILING_STOP   // stop that follows the best price by a fixed amount
+};
+
+enum class TimeInForce {
+    GTC,    // good till cancelled
+    IOC,    // immediate or cancel
+    FOK,    // fill or kill
+    GTT     // good till the engine clock reaches the expiry step
 };
 
 class Order {
 private:
-    static int nextOrderId;
+    static std::atomic<int> nextOrderId;
     int orderId;
     std::string symbol;
     OrderType type;
@@ -27,6 +44,12 @@ private:
     double filledQuantity;
     OrderStatus status;
     std::chrono::system_clock::time_point timestamp;
+    std::string tag; // originating strategy, used for cost attribution
+    ExecutionType executionType;
+    TimeInForce timeInForce;
+    double stopPrice;
+    double trailAmount;
+    long expiryStep;
 
 public:
     Order(const std::string& symbol, OrderType type, double quantity, double price);
@@ -44,11 +67,36 @@ public:
     
     // Setters
     void setStatus(OrderStatus newStatus) { status = newStatus; }
+    void setPrice(double newPrice) { price = newPrice; }
     void fillOrder(double fillQuantity);
+    void setTag(const std::string& newTag) { tag = newTag; }
+    const std::string& getTag() const { return tag; }
+    
+    // Order type and time in force (defaults: LIMIT, GTC)
+    ExecutionType getExecutionType() const { return executionType; }
+    TimeInForce getTimeInForce() const { return timeInForce; }
+    double getStopPrice() const { return stopPrice; }
+    double getTrailAmount() const { return trailAmount; }
+    long getExpiryStep() const { return expiryStep; }
+    void setExecutionType(ExecutionType newType) { executionType = newType; }
+    void setTimeInForce(TimeInForce tif, long expiresAtStep = -1) { timeInForce = tif; expiryStep = expiresAtStep; }
+    void setStopPrice(double stop) { stopPrice = stop; }
+    void setTrailAmount(double amount) { trailAmount = amount; }
+    
+    // Id counter, shared by every thread so ids stay unique across engines
+    // running side by side (SimulationBatch). The journal replayer sets it so
+    // replayed orders get the ids they were recorded with.
+    static int getNextOrderId() { return nextOrderId.load(std::memory_order_relaxed); }
+    static void setNextOrderId(int id) { nextOrderId.store(id, std::memory_order_relaxed); }
     
     // Utility methods
     bool isFullyFilled() const { return filledQuantity >= quantity; }
     std::string toString() const;
+    
+    // Allocation-free form of toString for hot-path logging; returns the
+    // length that would have been written, as snprintf does
+    static constexpr size_t FORMAT_BUFFER_SIZE = 192;
+    size_t format(char* buffer, size_t size) const;
 };
 
 #endif // ORDER_H
@@ -0,0 +1,126 @@
+// OrderBook.h
+// Per-symbol container for an engine's working orders: resting limit orders
+// in time priority plus trigger books for stop, stop-limit and trailing-stop
+// orders. Stop books are sorted by trigger price so a tick only touches the
+// triggers it actually crosses; trailing stops are grouped by the extreme
+// they trail and listed by stop level for the same reason. All containers
+// draw their nodes from a
+// per-book pool, so steady-state order churn does not reach the heap and a
+// book can be matched on any single thread.
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <optional>
+#include <memory_resource>
+#include "Order.h"
+
+class OrderBook {
+public:
+    // Buy stops trigger when the price rises to the stop, sell stops when it falls to it
+    using BuyStopBook = std::pmr::multimap<double, Order>;
+    using SellStopBook = std::pmr::multimap<double, Order, std::greater<double>>;
+
+private:
+    enum class Location {
+        RESTING,
+        BUY_STOP,
+        SELL_STOP,
+        TRAILING
+    };
+
+    // Trailing stops of one side, kept as for sells (buys use negated
+    // prices). Stops that have seen the same best price share a group keyed
+    // by it and sorted by trail amount; a price beyond a group's extreme
+    // moves the group rather than each stop. Groups are listed by their
+    // highest stop level, so a tick only visits the groups it triggers.
+    struct TrailGroup;
+    using TrailBook = std::pmr::multimap<double, Order>;   // trail amount -> order
+    using TrailLevels = std::pmr::multimap<double, TrailGroup*, std::greater<double>>;
+
+    struct TrailGroup {
+        double extreme;
+        TrailBook orders;
+        TrailLevels::iterator level;
+    };
+
+    struct TrailingSide {
+        std::pmr::map<double, TrailGroup> groups;   // extreme -> stops trailing it
+        TrailLevels levels;                         // highest stop level -> group
+
+        explicit TrailingSide(std::pmr::memory_resource* memory) : groups(memory), levels(memory) {}
+        bool empty() const { return groups.empty(); }
+    };
+
+    struct Entry {
+        Location location;
+        std::pmr::list<Order>::iterator resting;
+        BuyStopBook::iterator buyStop;
+        SellStopBook::iterator sellStop;
+        TrailBook::iterator trailing;
+        TrailGroup* trailGroup;
+    };
+
+    std::pmr::unsynchronized_pool_resource pool;    // must outlive the containers below
+    std::pmr::list<Order> resting;
+    BuyStopBook buyStops;
+    SellStopBook sellStops;
+    TrailingSide buyTrailing;
+    TrailingSide sellTrailing;
+    std::pmr::unordered_map<int, Entry> index;
+
+    TrailingSide& trailingSide(const Order& order) {
+        return order.getType() == OrderType::SELL ? sellTrailing : buyTrailing;
+    }
+    void addToGroup(TrailingSide& side, double extreme, const Order& order);
+    void removeFromGroup(TrailingSide& side, TrailGroup* group, TrailBook::iterator it);
+    void relevel(TrailingSide& side, TrailGroup* group);
+    void collectTrailing(TrailingSide& side, double price, std::vector<Order>& triggered);
+
+public:
+    // 'upstream' supplies the pool's blocks, e.g. a SimulationArena
+    explicit OrderBook(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : pool(upstream), resting(&pool), buyStops(&pool), sellStops(&pool), buyTrailing(&pool),
+          sellTrailing(&pool), index(&pool) {}
+    OrderBook(const OrderBook&) = delete;
+    OrderBook& operator=(const OrderBook&) = delete;
+
+    void addResting(const Order& order);
+    void addStop(const Order& order);
+    void addTrailingStop(const Order& order, double referencePrice);
+
+    // Remove a working order of any kind, returning it if it was present
+    std::optional<Order> remove(int orderId);
+    bool contains(int orderId) const { return index.find(orderId) != index.end(); }
+    size_t size() const { return index.size(); }
+    bool empty() const { return index.empty(); }
+    bool hasTriggers() const {
+        return !buyStops.empty() || !sellStops.empty() || !buyTrailing.empty() || !sellTrailing.empty();
+    }
+
+    // Move every trigger crossed by 'price' to 'triggered'. O(crossed) for the
+    // stop books; trailing stops also pay for the groups the price moves.
+    void collectTriggered(double price, std::vector<Order>& triggered);
+
+    // Offer resting orders to 'tryFill' in time priority; orders for which it
+    // returns true are removed from the book
+    template <typename FillFn>
+    void matchResting(FillFn&& tryFill) {
+        for (auto it = resting.begin(); it != resting.end();) {
+            if (tryFill(*it)) {
+                index.erase(it->getOrderId());
+                it = resting.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    const std::pmr::list<Order>& getResting() const { return resting; }
+};
+
+#endif // ORDER_BOOK_H
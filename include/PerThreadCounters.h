@@ -0,0 +1,65 @@
+// PerThreadCounters.h
+// Counters that many threads bump concurrently without sharing cache lines.
+// Each thread owns one slot (its worker index) padded to a full line, writes
+// it with plain relaxed stores instead of contended read-modify-writes, and
+// readers sum the slots. Totals read while writers run are approximate but
+// never torn.
+#ifndef PER_THREAD_COUNTERS_H
+#define PER_THREAD_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "NumaMemory.h"
+
+class PerThreadCounters {
+public:
+    static constexpr size_t MAX_COUNTERS = 7;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> values[MAX_COUNTERS];
+        uint64_t padding;   // the line holds nothing another slot writes
+    };
+    static_assert(sizeof(Slot) == CACHE_LINE_SIZE, "one slot per cache line");
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount;
+
+public:
+    explicit PerThreadCounters(size_t threads) : slots(new Slot[threads ? threads : 1]), slotCount(threads ? threads : 1) {
+        reset();
+    }
+
+    size_t size() const { return slotCount; }
+
+    // Only the thread owning 'slot' may add to it
+    void add(size_t slot, size_t counter, uint64_t amount = 1) {
+        std::atomic<uint64_t>& value = slots[slot].values[counter];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    uint64_t get(size_t slot, size_t counter) const {
+        return slots[slot].values[counter].load(std::memory_order_relaxed);
+    }
+
+    uint64_t total(size_t counter) const {
+        uint64_t sum = 0;
+        for (size_t slot = 0; slot < slotCount; ++slot) {
+            sum += get(slot, counter);
+        }
+        return sum;
+    }
+
+    // Not concurrent with add
+    void reset() {
+        for (size_t slot = 0; slot < slotCount; ++slot) {
+            for (auto& value : slots[slot].values) {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+#endif // PER_THREAD_COUNTERS_H
@@ -0,0 +1,77 @@
+// PerformanceAnalytics.h
+// Streaming performance and risk metrics for a Portfolio. Every metric is
+// updated online from equity snapshots, fills and marks, so memory stays
+// constant per metric (per symbol for attribution) regardless of run length.
+#ifndef PERFORMANCE_ANALYTICS_H
+#define PERFORMANCE_ANALYTICS_H
+
+#include <string>
+#include <map>
+#include <cstddef>
+
+class PerformanceAnalytics {
+private:
+    double periodsPerYear;
+    double initialEquity;
+    double lastEquity;
+    double peakEquity;
+    double currentDrawdown;
+    double maxDrawdown;
+    double equitySum;
+
+    // Per-period returns (Welford running mean/variance)
+    size_t periods;
+    double meanReturn;
+    double m2Return;
+    double downsideSumSq;
+
+    // Trading activity and exposure
+    double tradedNotional;
+    double grossExposure;
+    double netExposure;
+    double grossExposureSum;
+    double netExposureSum;
+
+    // Per-symbol PnL attribution
+    std::map<std::string, double> symbolPnL;
+    std::map<std::string, double> lastMark;
+
+public:
+    PerformanceAnalytics(double initialEquity = 100000.0, double periodsPerYear = 252.0);
+
+    // Feed
+    void recordEquity(double equity, double gross, double net);
+    void recordFill(const std::string& symbol, double signedQuantity, double price);
+    void recordMark(const std::string& symbol, double positionQuantity, double price);
+    void recordCost(const std::string& symbol, double amount);
+
+    // Equity curve
+    double getInitialEquity() const { return initialEquity; }
+    double getLastEquity() const { return lastEquity; }
+    double getPeakEquity() const { return peakEquity; }
+    double getCurrentDrawdown() const { return currentDrawdown; }
+    double getMaxDrawdown() const { return maxDrawdown; }
+    size_t getPeriodCount() const { return periods; }
+
+    // Risk-adjusted returns (annualized)
+    double getMeanReturn() const { return meanReturn; }
+    double getReturnVolatility() const;
+    double getSharpeRatio() const;
+    double getSortinoRatio() const;
+
+    // Activity and exposure
+    double getTradedNotional() const { return tradedNotional; }
+    double getTurnover() const;
+    double getGrossExposure() const { return grossExposure; }
+    double getNetExposure() const { return netExposure; }
+    double getAverageGrossExposure() const;
+    double getAverageNetExposure() const;
+
+    // Attribution
+    double getSymbolPnL(const std::string& symbol) const;
+    const std::map<std::string, double>& getAttribution() const { return symbolPnL; }
+
+    void printSummary() const;
+};
+
+#endif // PERFORMANCE_ANALYTICS_H
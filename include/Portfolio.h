@@ -4,53 +4,260 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <atomic>
 #include "Order.h"
+#include "Instrument.h"
+#include "TaxLots.h"
+#include "PerformanceAnalytics.h"
 
 struct Position {
     std::string symbol;
-    double quantity;
+    double quantity;        // negative for short positions
     double averagePrice;
     double unrealizedPnL;
     double realizedPnL;
-    
+
+    // Exact fixed-point state; the double fields above are derived from it
+    std::string currency;
+    Lots lots;
+    Money costBasis;        // signed: lots * entry price, negative for shorts
+    Money realized;
+    Money unrealized;
+    Money borrowCost;
+    Money fees;
+    Ticks markTicks;
+    TaxLotQueue taxLots;    // open lots; empty under LotMatching::AVERAGE_COST
+
     Position(const std::string& sym = "", double qty = 0.0, double price = 0.0)
-        : symbol(sym), quantity(qty), averagePrice(price), unrealizedPnL(0.0), realizedPnL(0.0) {}
+        : symbol(sym), quantity(qty), averagePrice(price), unrealizedPnL(0.0), realizedPnL(0.0),
+          currency("USD"), lots(0), costBasis(0), realized(0), unrealized(0), borrowCost(0), fees(0), markTicks(0) {}
+};
+
+// What a symbol's closed positions left behind. Flat positions are removed
+// from the position map; their PnL is carried here so it still counts.
+struct ClosedPnL {
+    std::string currency;
+    Money realized = 0;     // net of fees and borrow costs, like Position::realized
+    Money fees = 0;
+    Money borrowCost = 0;
+};
+
+// Atomic cash slot used for concurrent buying-power reservations. Copying
+// takes a snapshot so Portfolio itself stays copyable.
+struct ReservableCash {
+    std::atomic<Money> available{0};
+
+    ReservableCash() = default;
+    ReservableCash(const ReservableCash& other) : available(other.available.load()) {}
+    ReservableCash& operator=(const ReservableCash& other) {
+        available.store(other.available.load());
+        return *this;
+    }
+};
+
+// Map nodes of closed positions, kept so reopening a position does not
+// allocate. Copies start empty, keeping Portfolio copyable.
+struct PositionNodeCache {
+    std::vector<std::map<std::string, Position>::node_type> nodes;
+
+    PositionNodeCache() = default;
+    PositionNodeCache(const PositionNodeCache&) {}
+    PositionNodeCache& operator=(const PositionNodeCache&) { return *this; }
+};
+
+// Account settings. Leverage 1 is a cash account: buys are paid from cash in
+// the instrument currency, and the account is never margin-called. Above 1
+// it is a margin account: positions need notional / leverage of equity
+// (initial margin), equity below maintenanceMargin * gross exposure is a
+// margin call and below liquidationMargin * gross exposure the positions are
+// liquidated. Orders that only reduce a position never need margin.
+struct MarginPolicy {
+    double leverage = 1.0;
+    double maintenanceMargin = 0.25;
+    double liquidationMargin = 0.15;
+};
+
+// Account margin in the base currency
+struct MarginStatus {
+    double equity = 0.0;
+    double grossExposure = 0.0;     // sum of |position market value|
+    double initialMargin = 0.0;     // grossExposure / leverage
+    double maintenanceMargin = 0.0;
+    double reserved = 0.0;          // held for working orders
+    double excess = 0.0;            // equity - initialMargin - reserved: margin for new orders
+    bool marginCall = false;
+    bool liquidate = false;
+};
+
+enum class MarginEventType {
+    MARGIN_CALL,
+    LIQUIDATION
+};
+
+struct MarginEvent {
+    MarginEventType type;
+    long step;
+    MarginStatus status;
+};
+
+// Buying power held for one working order until it fills or leaves the book.
+// Returned by reserveOrder and handed back to releaseOrder with the order.
+struct Reservation {
+    Money cash = 0;         // instrument currency: notional + fee, or initial margin + fee
+    Lots closeLots = 0;     // lots of the current position the order would close
+
+    bool empty() const { return cash == 0 && closeLots == 0; }
 };
 
 class Portfolio {
 private:
-    double cash;
+    double initialCash;
     double totalValue;
+    std::string baseCurrency;
+    std::map<std::string, Money> cashBalances;  // per currency
+    std::map<std::string, double> fxRates;      // units of base currency per unit of currency
+    std::map<std::string, Instrument> instruments;
+    Instrument defaultInstrument;
     std::map<std::string, Position> positions;
+    PositionNodeCache spareNodes;
+    LotMatching lotMatching;
+    std::map<std::string, ClosedPnL> closedPnL;     // per symbol, from positions that went flat
+    std::vector<ClosedLot> closedLots;
+    bool keepClosedLots;
     std::vector<Order> orderHistory;
+    bool keepOrderHistory;
+    bool allowShortSelling;
+    PerformanceAnalytics analytics;
+    std::map<std::string, ReservableCash> reservableCash;
+    MarginPolicy marginPolicy;
+    std::map<std::string, Money> reservedCash;      // per currency, held for working orders
+    std::map<std::string, Lots> reservedCloseLots;  // per symbol, promised to working orders
+    double grossExposure;                           // base currency, kept with totalValue
+    double derivativesValue;                        // base currency, from the last settleDerivatives
+    double derivativesCashFlow;                     // base currency, premiums and variation margin to date
 
 public:
-    Portfolio(double initialCash = 100000.0);
-    
+    Portfolio(double initialCash = 100000.0, const std::string& baseCurrency = "USD");
+
     // Portfolio management
-    bool canAffordOrder(const Order& order) const;
-    void executeOrder(const Order& order, double executionPrice);
+    // 'fee' is charged in the instrument currency and counts against realized PnL.
+    // Buying power held for working orders is not available to other orders;
+    // 'held' is the order's own reservation when it is one of them. Fills are
+    // checked at 'executionPrice' (> 0), which can differ from the order's
+    // price, e.g. for triggered stops; otherwise the order's price is used.
+    bool canAffordOrder(const Order& order, double fee = 0.0, const Reservation* held = nullptr,
+                        double executionPrice = 0.0) const;
+    // Returns false, changing nothing, when the order cannot be afforded at
+    // 'executionPrice'; 'held' is its reservation, which the caller releases
+    // once the fill has succeeded
+    bool executeOrder(const Order& order, double executionPrice, double fee = 0.0,
+                      const Reservation* held = nullptr);
     void updatePositionValue(const std::string& symbol, double currentPrice);
+
+    // Instruments and currencies. Symbols without a registered instrument
+    // trade in the base currency with a 0.01 tick and 1-unit lots.
+    void registerInstrument(const Instrument& instrument);
+    const Instrument& getInstrument(const std::string& symbol) const;
+    // Currencies other than the base need a rate before they are held or
+    // traded: getFxRate and deposit throw std::out_of_range without one, and
+    // orders in such a currency cannot be afforded
+    void setFxRate(const std::string& currency, double rateToBase);
+    bool hasFxRate(const std::string& currency) const;
+    double getFxRate(const std::string& currency) const;
+    void deposit(const std::string& currency, double amount);
+    bool convertCurrency(const std::string& from, const std::string& to, double amount);
+
+    // Options and futures held in a DerivativesBook: 'cashFlow' (premiums and
+    // variation margin, positive when received) settles into base-currency
+    // cash, and 'bookValue' counts towards total value and total PnL
+    void settleDerivatives(double cashFlow, double bookValue);
+    double getDerivativesValue() const { return derivativesValue; }
+    double getDerivativesPnL() const { return derivativesCashFlow + derivativesValue; }
+
+    // Short selling; borrow is charged on short market value at the instrument's borrowRate
+    void setShortSellingEnabled(bool enable) { allowShortSelling = enable; }
+    bool isShortSellingEnabled() const { return allowShortSelling; }
+    void accrueBorrowCosts(double yearFraction);
+
+    // Margin and buying power for working orders. reserveOrder holds the
+    // order's requirement (check canAffordOrder first); releaseOrder returns it.
+    void setMarginPolicy(const MarginPolicy& policy);
+    const MarginPolicy& getMarginPolicy() const { return marginPolicy; }
+    bool isMarginAccount() const { return marginPolicy.leverage > 1.0; }
+    Reservation reserveOrder(const Order& order, double fee);
+    void releaseOrder(const Order& order, const Reservation& reservation);
+    double getReservedCash(const std::string& currency) const;
+    double getReservedCloseQuantity(const std::string& symbol) const;
+    MarginStatus getMarginStatus() const;
+    // True when the working orders' reservations exceed what the account now
+    // has (fees, borrow costs or price moves used it up)
+    bool isOverReserved() const;
+
+    // Lock-free buying-power reservations for sharded matching.
+    // beginReservations snapshots every cash balance less the cash held for
+    // working orders; afterwards any number of threads may reserve against it
+    // concurrently until balances next change. 'held' is the order's own
+    // reservation, which it may spend. This only pre-screens fills: they are
+    // booked later, one at a time, by executeOrder, which checks them again.
+    void beginReservations();
+    bool reserveBuyingPower(const Order& order, double executionPrice, double fee,
+                            const Reservation* held = nullptr);
     
     // Getters
-    double getCash() const { return cash; }
+    double getInitialCash() const { return initialCash; }
+    double getCash() const;                                   // all balances in base currency
+    double getCashBalance(const std::string& currency) const;
+    const std::string& getBaseCurrency() const { return baseCurrency; }
     double getTotalValue() const { return totalValue; }
     const std::map<std::string, Position>& getPositions() const { return positions; }
     const std::vector<Order>& getOrderHistory() const { return orderHistory; }
-    
+
     // Position queries
     bool hasPosition(const std::string& symbol) const;
     double getPositionQuantity(const std::string& symbol) const;
     double getPositionValue(const std::string& symbol, double currentPrice) const;
-    
+
+    // Lot matching for fills that reduce a position. Switching to FIFO/LIFO
+    // turns every open position into one lot at its average cost; switching
+    // to AVERAGE_COST blends the open lots.
+    void setLotMatching(LotMatching method);
+    LotMatching getLotMatching() const { return lotMatching; }
+    // Record every lot (or part of one) closed under FIFO/LIFO; off by default
+    void setKeepClosedLots(bool keep) { keepClosedLots = keep; }
+    const std::vector<ClosedLot>& getClosedLots() const { return closedLots; }
+
+    // PnL attribution in the base currency. Realized PnL (net of fees and
+    // borrow costs) includes positions that have since been closed.
+    double getRealizedPnL() const;
+    double getRealizedPnL(const std::string& symbol) const;
+    double getUnrealizedPnL() const;
+    const std::map<std::string, ClosedPnL>& getClosedPnL() const { return closedPnL; }
+
     // Portfolio analytics
     double getTotalPnL() const;
     double getPortfolioReturn() const;
     void printPortfolioSummary() const;
-    
+
+    // Streaming performance analytics. Call recordEquitySnapshot once per
+    // simulation step after positions have been marked to market.
+    void recordEquitySnapshot();
+    const PerformanceAnalytics& getAnalytics() const { return analytics; }
+
+    // Long backtests can stop retaining every executed order
+    void setKeepOrderHistory(bool keep) { keepOrderHistory = keep; }
+
 private:
-    void updateCash(double amount) { cash += amount; }
+    void updateCash(const std::string& currency, Money amount) { cashBalances[currency] += amount; }
+    double toBase(const std::string& currency, Money amount) const;
+    void refreshPosition(Position& pos, const Instrument& instrument);
+    std::map<std::string, Position>::iterator openPosition(const std::string& symbol);
+    void addLot(Position& pos, Lots lots, Money cost, Ticks ticks, int orderId);
+    Money closeLots(Position& pos, const Instrument& instrument, Lots lots, Ticks ticks, int orderId);
+    void closePosition(std::map<std::string, Position>::iterator it);
     void updateTotalValue();
+    Lots closableLots(const Order& order, Lots lots, const Reservation* held) const;
+    Money initialMarginFor(Money notional) const;
+    double reservedInBase() const;
 };
 
 #endif // PORTFOLIO_H
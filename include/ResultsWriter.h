@@ -0,0 +1,51 @@
+// ResultsWriter.h
+// Streams simulation results to columnar files instead of keeping them in
+// memory. Four tables are written next to each other:
+//   <prefix>_fills.tcol   step, orderId, symbol, side, quantity, price, fee, liquidity, strategy
+//   <prefix>_orders.tcol  step, orderId, symbol, event, side, type, quantity, price
+//   <prefix>_equity.tcol  step, cash, totalValue, pnl
+//   <prefix>_prices.tcol  step, symbol, price, return
+#ifndef RESULTS_WRITER_H
+#define RESULTS_WRITER_H
+
+#include <string>
+#include "ColumnarFile.h"
+#include "Order.h"
+#include "FeeModel.h"
+
+class Portfolio;
+class Market;
+
+enum class OrderEvent {
+    SUBMITTED,
+    TRIGGERED,
+    CANCELLED,
+    EXPIRED,
+    REJECTED
+};
+
+class ResultsWriter {
+private:
+    ColumnarWriter fills;
+    ColumnarWriter orderEvents;
+    ColumnarWriter equity;
+    ColumnarWriter prices;
+
+public:
+    explicit ResultsWriter(const std::string& pathPrefix, size_t chunkRows = 65536);
+
+    bool isOpen() const;
+
+    // Chunks queued across the four tables, for monitoring from any thread
+    size_t getPendingChunks() const;
+
+    void recordFill(long step, const Order& order, double price, double fee, LiquidityFlag liquidity);
+    void recordOrderEvent(long step, const Order& order, OrderEvent event);
+    void recordEquity(long step, const Portfolio& portfolio);
+    void recordPrices(long step, const Market& market);
+
+    // Flush every table and finish the files; further records are dropped
+    void close();
+};
+
+#endif // RESULTS_WRITER_H
@@ -0,0 +1,83 @@
+// RollingStatistics.h
+// Incremental rolling-window statistics for every symbol of a Market.
+// One instance exists per registered window length; all symbols share it and
+// values are kept column-wise (one contiguous array per statistic, indexed by
+// the symbol's position in the Market), so updating a symbol is O(1) and any
+// number of readers can query the results without rescanning price history.
+#ifndef ROLLING_STATISTICS_H
+#define ROLLING_STATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RollingStatistics {
+private:
+    size_t window;
+    double emaAlpha;
+
+    // Ring buffers, window entries per symbol (symbol i occupies [i*window, (i+1)*window))
+    std::vector<double> priceRing;
+    std::vector<double> volumeRing;
+    std::vector<double> returnRing;
+
+    // Monotonic deques (stored as rings of sequence numbers) for min/max
+    std::vector<uint64_t> minQueue;
+    std::vector<uint64_t> maxQueue;
+    std::vector<size_t> minHead, minSize;
+    std::vector<size_t> maxHead, maxSize;
+
+    // Per-symbol running state
+    std::vector<uint64_t> sequence;      // number of prices seen
+    std::vector<uint64_t> returnCount;   // number of returns seen
+    std::vector<double> lastPrice;
+    std::vector<double> priceSum;
+    std::vector<double> volumeSum;
+    std::vector<double> notionalSum;     // sum(price * volume)
+    std::vector<double> returnSum;
+    std::vector<double> returnSumSq;
+
+    // Published results
+    std::vector<double> sma;
+    std::vector<double> ema;
+    std::vector<double> variance;
+    std::vector<double> minimum;
+    std::vector<double> maximum;
+    std::vector<double> vwap;
+
+public:
+    explicit RollingStatistics(size_t windowLength);
+
+    size_t getWindow() const { return window; }
+    size_t getSymbolCount() const { return sequence.size(); }
+
+    // Grow the columns by one symbol; returns its index
+    size_t addSymbol();
+    void update(size_t index, double price, double volume);
+
+    // Per-symbol queries
+    size_t getCount(size_t index) const;
+    double getSMA(size_t index) const { return sma[index]; }
+    double getEMA(size_t index) const { return ema[index]; }
+    double getVariance(size_t index) const { return variance[index]; }
+    double getRealizedVolatility(size_t index, double periodsPerYear = 252.0) const;
+    double getMin(size_t index) const { return minimum[index]; }
+    double getMax(size_t index) const { return maximum[index]; }
+    double getVWAP(size_t index) const { return vwap[index]; }
+
+    // Whole columns, ordered by symbol index
+    const std::vector<double>& smaColumn() const { return sma; }
+    const std::vector<double>& emaColumn() const { return ema; }
+    const std::vector<double>& varianceColumn() const { return variance; }
+    const std::vector<double>& minColumn() const { return minimum; }
+    const std::vector<double>& maxColumn() const { return maximum; }
+    const std::vector<double>& vwapColumn() const { return vwap; }
+
+private:
+    void pushExtreme(std::vector<uint64_t>& queue, std::vector<size_t>& head, std::vector<size_t>& size,
+                     size_t index, uint64_t seq, double price, bool keepMin);
+    double priceAt(size_t index, uint64_t seq) const { return priceRing[index * window + seq % window]; }
+    void recomputeSums(size_t index);
+};
+
+#endif // ROLLING_STATISTICS_H
@@ -0,0 +1,48 @@
+// ShardWorkerPool.h
+// Fixed set of worker threads, one per shard, optionally pinned to CPU cores.
+// run() hands every worker its shard index and blocks until all are done,
+// which is the fork/join pattern the sharded matching step needs each tick.
+#ifndef SHARD_WORKER_POOL_H
+#define SHARD_WORKER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ShardWorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    const std::function<void(size_t)>* task;
+    uint64_t generation;
+    size_t remaining;
+    bool stopping;
+
+public:
+    explicit ShardWorkerPool(size_t workerCount, bool pinThreads = true);
+    // One worker per entry, pinned to that CPU (e.g. from NumaTopology::selectCpus)
+    explicit ShardWorkerPool(const std::vector<size_t>& cpus);
+    ~ShardWorkerPool();
+
+    ShardWorkerPool(const ShardWorkerPool&) = delete;
+    ShardWorkerPool& operator=(const ShardWorkerPool&) = delete;
+
+    size_t size() const { return threads.size(); }
+
+    // Run task(shard) on every worker and wait for all of them
+    void run(const std::function<void(size_t)>& shardTask);
+
+    // Pin the calling thread to a core (no-op where unsupported)
+    static bool pinCurrentThread(size_t core);
+
+private:
+    void workerLoop(size_t shard, bool pin, size_t cpu);
+};
+
+#endif // SHARD_WORKER_POOL_H
@@ -0,0 +1,72 @@
+// SimulationBatch.h
+// Runs many independent simulations side by side on pinned worker threads.
+// Each job builds its own Market, Portfolio and TradingEngine inside the call,
+// on the worker thread, with the engine drawing from a fresh SimulationArena
+// bound to that worker's NUMA node: everything the instance touches is first
+// touched, allocated and run on one node, and no two jobs share heap pages.
+// Progress is counted in PerThreadCounters, one cache line per worker.
+#ifndef SIMULATION_BATCH_H
+#define SIMULATION_BATCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "NumaMemory.h"
+#include "PerThreadCounters.h"
+#include "ShardWorkerPool.h"
+
+struct BatchConfig {
+    size_t workers = 0;             // 0: one per CPU
+    bool spreadNodes = true;        // round-robin workers over nodes; false fills one node first
+    std::vector<size_t> cpus;       // explicit worker CPUs; overrides the two above
+    size_t arenaChunkBytes = 4 << 20;
+};
+
+struct BatchJob {
+    size_t index;               // job number in [0, jobCount)
+    size_t worker;              // counter slot of the running worker
+    size_t node;                // NUMA node of the running worker
+    SimulationArena& arena;     // this job's arena; released when the job returns
+};
+
+class SimulationBatch {
+public:
+    // Counter slots; jobs may use the rest (up to PerThreadCounters::MAX_COUNTERS)
+    enum Counter : size_t {
+        JOBS = 0,
+        STEPS = 1,
+        FILLS = 2
+    };
+
+private:
+    size_t arenaChunkBytes;
+    std::vector<size_t> workerCpus;
+    std::vector<size_t> workerNodes;
+    ShardWorkerPool pool;
+    PerThreadCounters counters;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> nextJob;
+
+public:
+    explicit SimulationBatch(const BatchConfig& config = BatchConfig());
+
+    SimulationBatch(const SimulationBatch&) = delete;
+    SimulationBatch& operator=(const SimulationBatch&) = delete;
+
+    size_t getWorkerCount() const { return workerCpus.size(); }
+    size_t getWorkerCpu(size_t worker) const { return workerCpus[worker]; }
+    size_t getWorkerNode(size_t worker) const { return workerNodes[worker]; }
+
+    // Call job() once per index in [0, jobCount) and wait for all of them.
+    // Workers take the next index as they finish, so uneven jobs balance out.
+    // Jobs that store results by index should write them once, at the end.
+    void run(size_t jobCount, const std::function<void(BatchJob&)>& job);
+
+    PerThreadCounters& getCounters() { return counters; }
+    const PerThreadCounters& getCounters() const { return counters; }
+
+private:
+    static std::vector<size_t> chooseCpus(const BatchConfig& config);
+};
+
+#endif // SIMULATION_BATCH_H
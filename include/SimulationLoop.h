@@ -0,0 +1,202 @@
+// SimulationLoop.h
+// Template strategy host for parameter sweeps. Strategy, price model and fee
+// model are compile-time parameters, so a tick (price update, signal, order
+// generation and fills) has no virtual calls or map lookups and the compiler
+// can inline and vectorize across the stages. State is a handful of flat
+// arrays; accounting is simplified to cash plus signed positions.
+//
+// Requirements (checked with static_assert):
+//   PriceModel: void step(double* prices, double* returns, size_t count, std::mt19937& rng)
+//   Fees:       double computeFee(double quantity, double price, LiquidityFlag) const
+//   Strategy:   see StaticStrategy.h
+#ifndef SIMULATION_LOOP_H
+#define SIMULATION_LOOP_H
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "StaticStrategy.h"
+#include "CorrelatedPriceModel.h"
+#include "FeeModel.h"
+
+template <typename T, typename = void>
+struct IsStepPriceModel : std::false_type {};
+
+template <typename T>
+struct IsStepPriceModel<T, std::void_t<decltype(std::declval<T&>().step(
+    std::declval<double*>(), std::declval<double*>(), std::declval<size_t>(), std::declval<std::mt19937&>()))>>
+    : std::true_type {};
+
+template <typename T, typename = void>
+struct IsFeeSchedule : std::false_type {};
+
+template <typename T>
+struct IsFeeSchedule<T, std::void_t<decltype(double(std::declval<const T&>().computeFee(
+    std::declval<double>(), std::declval<double>(), std::declval<LiquidityFlag>())))>>
+    : std::true_type {};
+
+// Independent GBM, same discretization as Market::simulatePriceMovement
+class GbmStep {
+private:
+    std::vector<double> vols;
+    double drift;
+    double dt;
+    std::vector<double> shocks;
+    std::normal_distribution<double> normalDist;
+
+public:
+    explicit GbmStep(std::vector<double> volatilities = {}, double annualDrift = 0.05, double stepYears = 1.0 / 252.0)
+        : vols(std::move(volatilities)), drift(annualDrift), dt(stepYears), normalDist(0.0, 1.0) {}
+
+    void step(double* prices, double* returns, size_t count, std::mt19937& rng) {
+        if (vols.size() < count) {
+            vols.resize(count, 0.02);
+        }
+        shocks.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            shocks[i] = normalDist(rng);
+        }
+        applyShocks(prices, returns, count, vols.data(), shocks.data(), nullptr, drift, dt);
+    }
+
+    // Shared update kernel; 'jumps' may be null
+    static void applyShocks(double* prices, double* returns, size_t count, const double* vols,
+                            const double* shocks, const double* jumps, double drift, double dt) {
+        double sqrtDt = std::sqrt(dt);
+        for (size_t i = 0; i < count; ++i) {
+            double next = prices[i] * (1.0 + drift * dt + vols[i] * sqrtDt * shocks[i]);
+            if (jumps) {
+                next *= std::exp(jumps[i]);
+            }
+            next = std::max(0.01, next);
+            returns[i] = next / prices[i] - 1.0;
+            prices[i] = next;
+        }
+    }
+};
+
+// CorrelatedPriceModel driving the same update kernel
+class CorrelatedStep {
+private:
+    CorrelatedPriceModel model;
+    std::vector<double> vols;
+    double drift;
+    double dt;
+    std::vector<double> shocks;
+    std::vector<double> jumps;
+
+public:
+    CorrelatedStep(const CorrelatedPriceModel& priceModel, std::vector<double> volatilities,
+                   double annualDrift = 0.05, double stepYears = 1.0 / 252.0)
+        : model(priceModel), vols(std::move(volatilities)), drift(annualDrift), dt(stepYears) {}
+
+    void step(double* prices, double* returns, size_t count, std::mt19937& rng) {
+        model.generate(rng, dt, shocks, jumps);
+        if (vols.size() < count) {
+            vols.resize(count, 0.02);
+        }
+        size_t n = std::min(count, shocks.size());
+        GbmStep::applyShocks(prices, returns, n, vols.data(), shocks.data(), jumps.data(), drift, dt);
+    }
+};
+
+struct NoFees {
+    double computeFee(double, double, LiquidityFlag) const { return 0.0; }
+};
+
+struct SimulationResult {
+    double finalEquity = 0.0;
+    double totalFees = 0.0;
+    double maxDrawdown = 0.0;   // fraction of the running peak
+    size_t trades = 0;
+};
+
+template <typename Strategy, typename PriceModel = GbmStep, typename Fees = FeeModel>
+class SimulationLoop {
+    static_assert(IsStaticStrategy<Strategy>::value,
+                  "Strategy must provide name() and signal(const StrategyView&, double*)");
+    static_assert(IsStepPriceModel<PriceModel>::value,
+                  "PriceModel must provide step(double*, double*, size_t, std::mt19937&)");
+    static_assert(IsFeeSchedule<Fees>::value,
+                  "Fees must provide computeFee(double, double, LiquidityFlag) const");
+
+private:
+    Strategy strategy;
+    PriceModel priceModel;
+    Fees fees;
+    std::vector<double> prices;
+    std::vector<double> returns;
+    std::vector<double> positions;
+    std::vector<double> orders;
+    double cash;
+    bool allowShortSelling;
+
+public:
+    SimulationLoop(std::vector<double> initialPrices, double initialCash, Strategy s = Strategy(),
+                   PriceModel model = PriceModel(), Fees f = Fees())
+        : strategy(std::move(s)), priceModel(std::move(model)), fees(std::move(f)),
+          prices(std::move(initialPrices)), returns(prices.size(), 0.0), positions(prices.size(), 0.0),
+          orders(prices.size(), 0.0), cash(initialCash), allowShortSelling(false) {}
+
+    void setShortSellingEnabled(bool enable) { allowShortSelling = enable; }
+
+    // Fee tiers are not advanced: the schedule's current tier applies throughout
+    SimulationResult run(int steps, std::mt19937& rng) {
+        SimulationResult result;
+        size_t count = prices.size();
+        double peak = getEquity();
+
+        for (int step = 0; step < steps; ++step) {
+            priceModel.step(prices.data(), returns.data(), count, rng);
+
+            StrategyView view{prices.data(), returns.data(), positions.data(), count, cash};
+            strategy.signal(view, orders.data());
+
+            for (size_t i = 0; i < count; ++i) {
+                double qty = orders[i];
+                if (qty == 0.0) {
+                    continue;
+                }
+                double price = prices[i];
+                double fee = fees.computeFee(std::abs(qty), price, LiquidityFlag::TAKER);
+                bool affordable = (qty > 0.0) ? cash >= qty * price + fee
+                                              : allowShortSelling || positions[i] >= -qty;
+                if (!affordable) {
+                    continue;
+                }
+                cash -= qty * price + fee;
+                positions[i] += qty;
+                result.totalFees += fee;
+                ++result.trades;
+            }
+
+            double equity = getEquity();
+            peak = std::max(peak, equity);
+            if (peak > 0.0) {
+                result.maxDrawdown = std::max(result.maxDrawdown, (peak - equity) / peak);
+            }
+        }
+
+        result.finalEquity = getEquity();
+        return result;
+    }
+
+    double getEquity() const {
+        double equity = cash;
+        for (size_t i = 0; i < prices.size(); ++i) {
+            equity += positions[i] * prices[i];
+        }
+        return equity;
+    }
+
+    double getCash() const { return cash; }
+    const std::vector<double>& getPrices() const { return prices; }
+    const std::vector<double>& getPositions() const { return positions; }
+    Strategy& getStrategy() { return strategy; }
+    PriceModel& getPriceModel() { return priceModel; }
+};
+
+#endif // SIMULATION_LOOP_H
@@ -0,0 +1,107 @@
+// StaticStrategy.h
+// Compile-time strategy interface. A static strategy is any type with
+//   const char* name() const
+//   void signal(const StrategyView& view, double* orders)
+// where signal writes a signed order quantity per symbol (0 = no order).
+// SimulationLoop inlines it into the tick loop; StaticStrategyAdapter wraps
+// it as an IStrategy so the same type also runs inside the TradingEngine.
+#ifndef STATIC_STRATEGY_H
+#define STATIC_STRATEGY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "IStrategy.h"
+#include "Market.h"
+#include "Portfolio.h"
+#include "TradingEngine.h"
+
+// Columnar view of one tick, indexed like Market::getSymbolsByIndex()
+struct StrategyView {
+    const double* prices;
+    const double* returns;      // fractional return over the last step
+    const double* positions;    // signed quantity held
+    size_t count;
+    double cash;
+};
+
+// Trait checks standing in for concepts (the tree is C++17)
+template <typename T, typename = void>
+struct IsStaticStrategy : std::false_type {};
+
+template <typename T>
+struct IsStaticStrategy<T, std::void_t<
+    decltype(std::declval<T&>().signal(std::declval<const StrategyView&>(), std::declval<double*>())),
+    decltype(std::string(std::declval<const T&>().name()))>> : std::true_type {};
+
+// Static counterpart of MomentumStrategy: buy on a daily return above the
+// threshold (in percent), sell half the order size on a drop while long
+struct MomentumSignal {
+    double returnThreshold = 0.02;
+    double orderQty = 10.0;
+
+    const char* name() const { return "MomentumSignal"; }
+
+    void signal(const StrategyView& view, double* orders) const {
+        double threshold = returnThreshold * 0.01;
+        double buyQty = orderQty;
+        double sellQty = std::max(1.0, orderQty / 2.0);
+        // Selects rather than branches; GCC if-converts and vectorizes this
+        // loop once FP compares may not trap (-fno-trapping-math, on in Release)
+        const double* returns = view.returns;
+        const double* positions = view.positions;
+        size_t count = view.count;
+        for (size_t i = 0; i < count; ++i) {
+            double r = returns[i];
+            double buy = (r > threshold) ? buyQty : 0.0;
+            double sell = (r < -threshold) ? sellQty : 0.0;
+            sell = (positions[i] > 0.0) ? sell : 0.0;
+            orders[i] = buy - sell;
+        }
+    }
+};
+
+// Runtime-polymorphic wrapper: runs a static strategy through IStrategy
+template <typename Strategy>
+class StaticStrategyAdapter : public IStrategy {
+    static_assert(IsStaticStrategy<Strategy>::value,
+                  "Strategy must provide name() and signal(const StrategyView&, double*)");
+
+private:
+    Strategy strategy;
+    std::vector<double> positions;
+    std::vector<double> orders;
+
+public:
+    explicit StaticStrategyAdapter(Strategy s = Strategy()) : strategy(std::move(s)) {}
+
+    std::string name() const override { return strategy.name(); }
+    Strategy& getStrategy() { return strategy; }
+
+    void onTick(Market& market, Portfolio& portfolio, TradingEngine& engine, int) override {
+        const MarketSnapshot& snap = market.getSnapshot();
+        const std::vector<std::string>& symbols = market.getSymbolsByIndex();
+        size_t count = snap.size();
+        positions.resize(count);
+        orders.assign(count, 0.0);
+        for (size_t i = 0; i < count; ++i) {
+            positions[i] = portfolio.getPositionQuantity(symbols[i]);
+        }
+
+        StrategyView view{snap.prices.data(), snap.returns.data(), positions.data(), count, portfolio.getCash()};
+        strategy.signal(view, orders.data());
+
+        for (size_t i = 0; i < count; ++i) {
+            if (orders[i] > 0.0) {
+                engine.executeMarketOrder(symbols[i], OrderType::BUY, orders[i]);
+            } else if (orders[i] < 0.0) {
+                engine.executeMarketOrder(symbols[i], OrderType::SELL, -orders[i]);
+            }
+        }
+    }
+};
+
+#endif // STATIC_STRATEGY_H
@@ -0,0 +1,93 @@
+// TaxLots.h
+// Lot-level position accounting. With FIFO or LIFO matching every fill that
+// opens or extends a position adds a TaxLot, and fills that reduce it consume
+// lots from the oldest or newest end, so realized PnL is measured against the
+// lots actually closed instead of a blended average price. TaxLotQueue keeps
+// the open lots of one position in a ring buffer: both ends are O(1) and its
+// storage is reused after the position closes, so matching costs O(lots
+// consumed) per fill and steady-state trading does not allocate.
+#ifndef TAX_LOTS_H
+#define TAX_LOTS_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Instrument.h"
+
+enum class LotMatching {
+    AVERAGE_COST,   // one blended cost basis per position; no lots are kept
+    FIFO,           // close the oldest open lots first
+    LIFO            // close the newest open lots first
+};
+
+struct TaxLot {
+    Lots lots;          // remaining size, always positive
+    Money cost;         // remaining cost basis, always positive
+    Ticks entryTicks;   // fill price that opened the lot
+    int orderId;        // order that opened it (0 for a lot carried over from average cost)
+};
+
+// Part of a lot closed by a fill; recorded when Portfolio::setKeepClosedLots is on
+struct ClosedLot {
+    std::string symbol;
+    int openOrderId;
+    int closeOrderId;
+    double quantity;        // negative for a short lot
+    double entryPrice;
+    double exitPrice;
+    double realizedPnL;     // instrument currency, before fees and borrow costs
+};
+
+// Open lots of one position, oldest first
+class TaxLotQueue {
+private:
+    std::vector<TaxLot> buffer;     // power-of-two capacity
+    size_t head;
+    size_t count;
+
+public:
+    TaxLotQueue() : head(0), count(0) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return buffer.size(); }
+
+    // i = 0 is the oldest open lot
+    const TaxLot& operator[](size_t i) const { return buffer[(head + i) & (buffer.size() - 1)]; }
+    TaxLot& front() { return buffer[head]; }
+    TaxLot& back() { return buffer[(head + count - 1) & (buffer.size() - 1)]; }
+
+    void push_back(const TaxLot& lot) {
+        if (count == buffer.size()) {
+            grow();
+        }
+        buffer[(head + count) & (buffer.size() - 1)] = lot;
+        ++count;
+    }
+
+    void pop_front() {
+        head = (head + 1) & (buffer.size() - 1);
+        --count;
+    }
+
+    void pop_back() { --count; }
+
+    // Keeps the storage for the next position
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    void grow() {
+        std::vector<TaxLot> larger(buffer.empty() ? 4 : buffer.size() * 2);
+        for (size_t i = 0; i < count; ++i) {
+            larger[i] = (*this)[i];
+        }
+        buffer = std::move(larger);
+        head = 0;
+    }
+};
+
+#endif // TAX_LOTS_H
@@ -0,0 +1,36 @@
+// TimerWheel.h
+// Hashed timer wheel keyed by engine step. Scheduling is O(1) and advancing
+// one step only touches the slot for that step, so expiring good-till-time
+// orders does not require scanning the order books.
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <vector>
+
+class TimerWheel {
+private:
+    struct Timer {
+        int id;
+        long expiryStep;
+    };
+
+    static constexpr size_t INITIAL_SLOT_CAPACITY = 8;
+
+    std::vector<std::vector<Timer>> slots;
+    size_t scheduled;
+
+public:
+    explicit TimerWheel(size_t slotCount = 256);
+
+    void schedule(int id, long expiryStep);
+
+    // Collect ids whose expiry step is <= 'step' from the slot for 'step'.
+    // Must be called for every consecutive step. Ids of timers whose owner is
+    // already gone are returned as well; callers ignore unknown ids.
+    void advance(long step, std::vector<int>& expired);
+
+    size_t size() const { return scheduled; }
+};
+
+#endif // TIMER_WHEEL_H
@@ -2,25 +2,125 @@
 #define TRADING_ENGINE_H
 
 #include <vector>
-#include <queue>
 #include <memory>
+#include <map>
+#include <unordered_map>
+#include <memory_resource>
+#include <string>
+#include <random>
 #include "Order.h"
+#include "OrderBook.h"
+#include "TimerWheel.h"
+#include "LatencyModel.h"
+#include "FeeModel.h"
+#include "ShardWorkerPool.h"
 #include "Portfolio.h"
 #include "Market.h"
+#include "IStrategy.h"
+#include "ResultsWriter.h"
+#include "InputJournal.h"
+#include "Derivatives.h"
+#include "MetricsExporter.h"
+#include "NumaMemory.h"
 
 class TradingEngine {
 private:
+    struct WorkingOrder {
+        OrderBook* book;
+        Reservation reservation;    // buying power held on the Portfolio
+    };
+
     Market& market;
     Portfolio& portfolio;
-    std::queue<Order> pendingOrders;
+    // Upstream of the per-book pools, over the engine's memory resource.
+    // Shard workers grow their books' pools concurrently and that resource
+    // (e.g. a SimulationArena) need not be thread safe, so refills are
+    // serialized here.
+    std::pmr::synchronized_pool_resource bookMemory;
+    std::pmr::map<std::string, OrderBook> books;    // working orders per symbol
+    std::pmr::unsynchronized_pool_resource indexPool;
+    std::pmr::unordered_map<int, WorkingOrder> workingOrders; // working order id -> its book
+    TimerWheel expiryTimers;                        // GTT expiries by engine step
+    long currentStep;
     std::vector<Order> executedOrders;
-    double transactionCost;
+    bool keepExecutedOrders;
+    size_t executedCount;
+    size_t buyCount;
+    size_t sellCount;
+    double executedNotional;
+    ResultsWriter* resultsWriter;   // not owned
+    InputJournal* journal;          // not owned
+    DerivativesBook* derivatives;   // not owned
+    MetricsPublisher* metrics;      // not owned
+    std::vector<Order> triggeredScratch;
+    std::vector<int> expiredScratch;
+    FeeModel feeModel;
     bool enableLogging;
+    std::string activeStrategy;
+    std::vector<IStrategy*> strategies;     // not owned
+    std::vector<std::string> strategyNames;
+    std::string savedStrategy;              // reused so tagging does not allocate per step
+    char logBuffer[Order::FORMAT_BUFFER_SIZE];
+    
+    // Latency model: once configured, strategy orders and cancels are sent
+    // through 'inFlight' and take effect when they arrive
+    bool latencyEnabled;
+    bool deliveringMessages;
+    LatencyProfile defaultLatency;
+    std::map<std::string, LatencyProfile> strategyLatency;
+    long maxProcessingJitter;
+    std::mt19937 latencyRandom;
+    LatencyQueue inFlight;
+    std::map<std::string, long> lastArrival;    // per strategy, keeps its messages in send order
+    std::vector<LatencyQueue::Message> arrivedMessages;
+    
+    // Hot-path allocation tracking (counts stay zero unless compiled in)
+    uint64_t hotPathAllocations;
+    long allocatingSteps;
+    
+    // Margin: checked once per processOrders step
+    std::vector<MarginEvent> marginEvents;
+    bool marginCallActive;
+    std::vector<int> uncoveredScratch;
+    std::vector<Order> liquidationScratch;
+    
+    // Order flow counters, published with the live metrics
+    uint64_t ordersReceived;
+    uint64_t orderEventCounts[EngineMetrics::ORDER_EVENTS];
+    
+    // Fee aggregation
+    double totalFees;
+    std::map<std::string, double> feesBySymbol;
+    std::map<std::string, double> feesByStrategy;
+    
+    // Sharded matching: each shard owns a slice of the symbol books and is
+    // matched by its own worker; fills are applied to the Portfolio afterwards
+    struct ShardFill {
+        Order order;
+        double price;
+        LiquidityFlag liquidity;
+    };
+    // Workers write their own shard concurrently, so shards never share a line
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::vector<std::pair<const std::string*, OrderBook*>> books;
+        std::vector<ShardFill> fills;
+        std::vector<Order> cancelled;
+        std::vector<Order> triggered;      // as collected, for the TRIGGERED events
+    };
+    std::unique_ptr<ShardWorkerPool> workerPool;
+    std::vector<Shard> shards;
+    size_t shardedBookCount;
 
 public:
-    TradingEngine(Market& mkt, Portfolio& port, double txnCost = 5.0);
+    // Order books and the working-order index allocate from 'memoryResource'
+    // (see SimulationArena); it must outlive the engine. It is only called
+    // from one thread at a time, also when sharding is enabled.
+    TradingEngine(Market& mkt, Portfolio& port, double txnCost = 5.0,
+                  std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource());
     
-    // Order management
+    // Order management. Each processOrders call advances the engine clock by
+    // one step, expires GTT orders, fires crossed triggers and matches
+    // resting limit orders.
     bool submitOrder(const Order& order);
     void processOrders();
     void cancelOrder(int orderId);
@@ -28,24 +128,121 @@ public:
     // Trading strategies
     void executeMarketOrder(const std::string& symbol, OrderType type, double quantity);
     void executeLimitOrder(const std::string& symbol, OrderType type, double quantity, double price);
+    void executeStopOrder(const std::string& symbol, OrderType type, double quantity, double stopPrice);
+    void executeStopLimitOrder(const std::string& symbol, OrderType type, double quantity,
+                               double stopPrice, double limitPrice);
+    void executeTrailingStopOrder(const std::string& symbol, OrderType type, double quantity, double trailAmount);
     
     // Engine configuration
-    void setTransactionCost(double cost) { transactionCost = cost; }
+    void setTransactionCost(double cost) { feeModel.setPerOrderFee(cost); }
+    void setFeeModel(const FeeModel& model) { feeModel = model; }
+    FeeModel& getFeeModel() { return feeModel; }
     void enableOrderLogging(bool enable) { enableLogging = enable; }
     
+    // Stream fills, order events, equity and prices to columnar files.
+    // Long runs can combine this with setKeepExecutedOrders(false).
+    void setResultsWriter(ResultsWriter* writer) { resultsWriter = writer; }
+    void setKeepExecutedOrders(bool keep) { keepExecutedOrders = keep; }
+    
+    // Record every order-entry call, processOrders step and market tick so
+    // the run can be reproduced with JournalReplayer. Attaching records the
+    // market's symbols; pass nullptr to stop.
+    void setJournal(InputJournal* inputJournal);
+    
+    // Working orders hold buying power on the Portfolio (see
+    // Portfolio::reserveOrder) until they fill, are cancelled or expire. Each
+    // processOrders step checks the account once: a margin account below
+    // maintenance margin raises a MARGIN_CALL event, below liquidation margin
+    // its working orders are cancelled and its positions closed at market
+    // (LIQUIDATION), and if the reservations exceed what the account still
+    // has, the newest working orders are cancelled until they fit.
+    const std::vector<MarginEvent>& getMarginEvents() const { return marginEvents; }
+    bool isMarginCallActive() const { return marginCallActive; }
+    
+    // Revalue options and futures on market symbols in markToMarket and
+    // settle their cash flows and book value into the Portfolio
+    void setDerivativesBook(DerivativesBook* book) { derivatives = book; }
+    
+    // Publish an EngineMetrics snapshot at the end of every runSimulation
+    // step (with its wall time) for a MetricsExporter to serve. Drivers that
+    // step the engine themselves call publishMetrics.
+    void setMetricsPublisher(MetricsPublisher* publisher) { metrics = publisher; }
+    void publishMetrics();
+    
+    // Match symbols on 'shardCount' worker threads (pinned to cores when
+    // requested). Symbols are assigned by market index; buying power is shared
+    // through lock-free reservations on the Portfolio. 0 or 1 disables.
+    // Only triggering, matching and the cash pre-check run on the workers;
+    // every fill is then applied to the Portfolio serially on the calling
+    // thread, so sharding pays off when matching dominates the step (many
+    // resting orders per fill), not when fills do.
+    void enableSharding(size_t shardCount, bool pinThreads = true);
+    size_t getShardCount() const { return shards.size(); }
+    
+    // Latency. Delays are in engine steps: an order sent during step t with an
+    // order-entry delay of d (plus up to maxJitter steps of processing jitter)
+    // is handled by the processOrders call of step t + d, so a delay of one
+    // or more fills at a later price than the strategy saw. Market-data delay
+    // makes the strategy's onTick see prices that many updates old. Profiles
+    // are per strategy name; the default applies to everything else. Once any
+    // latency is configured, submit/cancel calls return after sending and the
+    // order takes effect in processOrders. Jitter never reorders one
+    // strategy's messages: each arrives no earlier than the one sent before it.
+    void setLatency(const LatencyProfile& profile);
+    void setStrategyLatency(const std::string& strategy, const LatencyProfile& profile);
+    void setProcessingJitter(long maxJitterSteps, unsigned int seed = 42);
+    size_t getInFlightCount() const { return inFlight.size(); }
+    
+    // Orders created while a strategy is active are tagged with its name
+    // (unless already tagged) so fees can be attributed per strategy
+    void setActiveStrategy(const std::string& name) { activeStrategy = name; }
+    
+    // Registered strategies get onTick every runSimulation step, with their
+    // orders tagged by name, and onOrderExecuted for their own fills
+    void addStrategy(IStrategy* strategy);
+    
     // Query methods
     const std::vector<Order>& getExecutedOrders() const { return executedOrders; }
-    size_t getPendingOrderCount() const { return pendingOrders.size(); }
+    size_t getExecutedOrderCount() const { return executedCount; }
+    uint64_t getHotPathAllocations() const { return hotPathAllocations; }
+    size_t getPendingOrderCount() const { return workingOrders.size(); }
+    uint64_t getOrderEventCount(OrderEvent event) const { return orderEventCounts[static_cast<size_t>(event)]; }
+    long getCurrentStep() const { return currentStep; }
+    double getTotalFees() const { return totalFees; }
+    const std::map<std::string, double>& getFeesBySymbol() const { return feesBySymbol; }
+    const std::map<std::string, double>& getFeesByStrategy() const { return feesByStrategy; }
     
     // Simulation control
     void runSimulation(int steps);
+    
+    // Revalue the portfolio after a price update (runSimulation does this
+    // every step); drivers that update the Market themselves call it too
+    void markToMarket();
     void printTradingStats() const;
     
 private:
     bool validateOrder(const Order& order) const;
-    bool tryExecuteOrder(Order& order);
+    bool tryExecuteOrder(Order& order, LiquidityFlag liquidity);
+    bool isMarketable(const Order& order, double price) const;
+    bool applyFill(Order& order, double price, LiquidityFlag liquidity);
+    void recordOrderEvent(const Order& order, OrderEvent event);
+    const char* describe(const Order& order);   // formats into logBuffer
+    void processOrdersSharded();
+    void matchShard(size_t shard);
+    void rebuildShards();
+    const LatencyProfile& latencyFor(const std::string& strategy) const;
+    void sendMessage(LatencyQueue::Kind kind, int orderId, const Order* order);
+    void deliverMessages();
+    void addWorkingOrder(const Order& order);
+    void activateTriggeredOrder(OrderBook& book, Order& order);
+    void expireOrders();
+    OrderBook& bookFor(const std::string& symbol);
+    void removeWorkingOrder(const Order& order);
+    void checkMargin();
+    void cancelUncoveredOrders(bool all);
+    void liquidatePositions();
+    void raiseMarginEvent(MarginEventType type, const MarginStatus& status);
     void logOrderExecution(const Order& order, double executionPrice) const;
-    double calculateOrderValue(const Order& order, double price) const;
 };
 
 #endif // TRADING_ENGINE_H
@@ -0,0 +1,257 @@
+// WalkForwardOptimizer.h
+// Parameter search for static strategies (see StaticStrategy.h) over cached
+// market paths. ParameterSearch proposes points by grid, random or Bayesian
+// (Gaussian-process expected improvement) search; WalkForwardOptimizer
+// evaluates them in parallel with SimulationLoop replaying a MarketPath,
+// picks the best in-sample parameters per training window and scores them on
+// the following out-of-sample window.
+//
+// Prices and returns are produced once when the MarketPath is built and shared
+// read-only by every evaluation. Results are cached per window by parameter
+// vector, so grid points that snap to the same values and repeated Bayesian
+// proposals are simulated only once.
+#ifndef WALK_FORWARD_OPTIMIZER_H
+#define WALK_FORWARD_OPTIMIZER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "MarketPath.h"
+#include "SimulationLoop.h"
+#include "ShardWorkerPool.h"
+
+enum class SearchMethod {
+    GRID,
+    RANDOM,
+    BAYESIAN
+};
+
+struct ParameterRange {
+    std::string name;
+    double min;
+    double max;
+    double step;        // grid spacing and snapping; 0 = continuous
+    bool integer;       // round to whole numbers
+};
+
+struct SearchConfig {
+    SearchMethod method = SearchMethod::GRID;
+    size_t budget = 64;             // evaluations per window for RANDOM and BAYESIAN
+    size_t gridPoints = 5;          // per dimension when a range has no step
+    size_t initialSamples = 10;     // random points before the GP takes over
+    size_t candidatePool = 512;     // random points expected improvement is maximized over
+    double lengthScale = 0.2;       // RBF kernel length in normalized [0, 1] units
+    unsigned int seed = 42;
+};
+
+// Proposes parameter vectors in batches and learns from reported scores
+// (higher is better). Bayesian batches use the "kriging believer" heuristic:
+// each pick is added to the model at its predicted mean before the next one.
+class ParameterSearch {
+private:
+    std::vector<ParameterRange> ranges;
+    SearchConfig config;
+    std::mt19937 rng;
+    std::vector<std::vector<double>> grid;
+    size_t proposed;
+    std::vector<std::vector<double>> observedPoints;    // normalized to [0, 1]
+    std::vector<double> observedScores;
+
+public:
+    ParameterSearch(std::vector<ParameterRange> parameterRanges, const SearchConfig& searchConfig);
+
+    // Up to maxBatch new points to evaluate; false once the budget is spent
+    bool nextBatch(size_t maxBatch, std::vector<std::vector<double>>& batch);
+    void report(const std::vector<double>& parameters, double score);
+
+    // Total points this search proposes
+    size_t getPlannedEvaluations() const;
+
+    // Clamp and snap a point to the ranges' steps and integer flags
+    std::vector<double> snap(const std::vector<double>& parameters) const;
+
+private:
+    std::vector<double> randomPoint();
+    std::vector<double> normalize(const std::vector<double>& parameters) const;
+    std::vector<double> denormalize(const std::vector<double>& unit) const;
+    void buildGrid();
+    void proposeBayesian(size_t count, std::vector<std::vector<double>>& batch);
+};
+
+struct Evaluation {
+    std::vector<double> parameters;
+    double score = 0.0;
+    SimulationResult result;
+};
+
+// Path rows are [trainStart, testStart) in-sample and [testStart, testEnd)
+// out-of-sample
+struct WalkForwardWindow {
+    size_t trainStart = 0;
+    size_t testStart = 0;
+    size_t testEnd = 0;
+    Evaluation best;            // in-sample winner
+    Evaluation outOfSample;     // the winner replayed on the test rows
+    size_t evaluations = 0;     // distinct parameter sets simulated
+    size_t cacheHits = 0;
+};
+
+struct WalkForwardConfig {
+    int trainSteps = 504;
+    int testSteps = 126;
+    bool anchored = false;          // grow the training window from row 0 instead of rolling it
+    double initialCash = 100000.0;
+    size_t threads = 0;             // 0 = hardware concurrency
+    SearchConfig search;
+};
+
+template <typename Strategy, typename Fees = FeeModel>
+class WalkForwardOptimizer {
+    static_assert(IsStaticStrategy<Strategy>::value,
+                  "Strategy must provide name() and signal(const StrategyView&, double*)");
+    static_assert(IsFeeSchedule<Fees>::value,
+                  "Fees must provide computeFee(double, double, LiquidityFlag) const");
+
+public:
+    // Builds a strategy from a parameter vector; called concurrently
+    using Factory = std::function<Strategy(const std::vector<double>&)>;
+    // Score to maximize; the default is the total return
+    using Objective = std::function<double(const SimulationResult&, double initialCash)>;
+
+private:
+    std::vector<ParameterRange> ranges;
+    Factory factory;
+    Fees fees;
+    WalkForwardConfig config;
+    Objective objective;
+    std::unique_ptr<ShardWorkerPool> workers;
+
+public:
+    WalkForwardOptimizer(std::vector<ParameterRange> parameterRanges, Factory strategyFactory,
+                         Fees f = Fees(), WalkForwardConfig walkConfig = WalkForwardConfig())
+        : ranges(std::move(parameterRanges)), factory(std::move(strategyFactory)), fees(std::move(f)),
+          config(walkConfig),
+          objective([](const SimulationResult& result, double initialCash) {
+              return initialCash > 0.0 ? result.finalEquity / initialCash - 1.0 : 0.0;
+          }) {
+        size_t threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+        if (threads > 1) {
+            workers.reset(new ShardWorkerPool(threads, false));
+        }
+    }
+
+    void setObjective(Objective scoreFunction) { objective = std::move(scoreFunction); }
+    const WalkForwardConfig& getConfig() const { return config; }
+
+    // Simulate one parameter set on rows [start, start + steps] of the path
+    Evaluation evaluate(const std::vector<double>& parameters, const MarketPath& path,
+                        size_t start, size_t steps) const {
+        SimulationLoop<Strategy, PathReplay, Fees> loop(path.getPricesAt(start), config.initialCash,
+                                                        factory(parameters), PathReplay(&path, start), fees);
+        std::mt19937 unused;
+        Evaluation evaluation;
+        evaluation.parameters = parameters;
+        evaluation.result = loop.run(static_cast<int>(steps), unused);
+        evaluation.score = objective(evaluation.result, config.initialCash);
+        return evaluation;
+    }
+
+    // Search the window starting at 'start' and return the best evaluation
+    Evaluation optimize(const MarketPath& path, size_t start, size_t steps,
+                        size_t* evaluations = nullptr, size_t* cacheHits = nullptr) {
+        ParameterSearch search(ranges, config.search);
+        std::map<std::vector<double>, Evaluation> cache;
+        std::vector<std::vector<double>> batch;
+        std::vector<std::vector<double>> pending;
+        std::vector<Evaluation> results;
+        Evaluation best;
+        bool haveBest = false;
+        size_t hits = 0;
+        size_t batchSize = workers ? workers->size() * 4 : 16;
+
+        while (search.nextBatch(batchSize, batch)) {
+            pending.clear();
+            for (std::vector<double>& point : batch) {
+                point = search.snap(point);
+                if (cache.count(point) || std::find(pending.begin(), pending.end(), point) != pending.end()) {
+                    ++hits;
+                } else {
+                    pending.push_back(point);
+                }
+            }
+
+            // Only new points are reported; cached ones are already known to the search
+            evaluateAll(pending, path, start, steps, results);
+            for (Evaluation& evaluation : results) {
+                search.report(evaluation.parameters, evaluation.score);
+                if (!haveBest || evaluation.score > best.score) {
+                    best = evaluation;
+                    haveBest = true;
+                }
+                std::vector<double> key = evaluation.parameters;
+                cache.emplace(std::move(key), std::move(evaluation));
+            }
+        }
+
+        if (evaluations) {
+            *evaluations = cache.size();
+        }
+        if (cacheHits) {
+            *cacheHits = hits;
+        }
+        return best;
+    }
+
+    // Roll (or grow, when anchored) a training window over the path; each
+    // window's winner is scored on the testSteps rows that follow it
+    std::vector<WalkForwardWindow> run(const MarketPath& path) {
+        std::vector<WalkForwardWindow> windows;
+        if (config.trainSteps <= 0 || config.testSteps <= 0) {
+            return windows;
+        }
+        size_t train = static_cast<size_t>(config.trainSteps);
+        size_t test = static_cast<size_t>(config.testSteps);
+
+        for (size_t testStart = train; testStart + test <= path.getStepCount(); testStart += test) {
+            WalkForwardWindow window;
+            window.trainStart = config.anchored ? 0 : testStart - train;
+            window.testStart = testStart;
+            window.testEnd = testStart + test;
+            window.best = optimize(path, window.trainStart, testStart - window.trainStart,
+                                   &window.evaluations, &window.cacheHits);
+            window.outOfSample = evaluate(window.best.parameters, path, testStart, test);
+            windows.push_back(std::move(window));
+        }
+        return windows;
+    }
+
+private:
+    void evaluateAll(const std::vector<std::vector<double>>& points, const MarketPath& path,
+                     size_t start, size_t steps, std::vector<Evaluation>& results) {
+        results.assign(points.size(), Evaluation());
+        if (!workers || points.size() < 2) {
+            for (size_t i = 0; i < points.size(); ++i) {
+                results[i] = evaluate(points[i], path, start, steps);
+            }
+            return;
+        }
+
+        // Workers pull the next point until the batch is drained
+        std::atomic<size_t> next{0};
+        workers->run([&](size_t) {
+            for (size_t i = next.fetch_add(1); i < points.size(); i = next.fetch_add(1)) {
+                results[i] = evaluate(points[i], path, start, steps);
+            }
+        });
+    }
+};
+
+#endif // WALK_FORWARD_OPTIMIZER_H
@@ -1,10 +1,16 @@
 #include <iostream>
+#include <iomanip>
 #include <thread>
 #include <chrono>
 #include "include/Order.h"
 #include "include/Portfolio.h"
 #include "include/Market.h"
 #include "include/TradingEngine.h"
+#include "include/ExchangeAgents.h"
+#include "include/SimulationLoop.h"
+#include "include/WalkForwardOptimizer.h"
+#include "include/Derivatives.h"
+#include "include/MetricsExporter.h"
 
 using namespace std;
 
@@ -98,6 +104,7 @@ void demonstrateAdvancedTrading()
         {
             portfolio.updatePositionValue(symbol, market.getCurrentPrice(symbol));
         }
+        portfolio.recordEquitySnapshot();
 
         // Print status every 10 days
         if ((day + 1) % 10 == 0)
@@ -111,6 +118,7 @@ void demonstrateAdvancedTrading()
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
+    portfolio.getAnalytics().printSummary();
     engine.printTradingStats();
 }
 
@@ -140,6 +148,209 @@ void demonstrateOrderManagement()
     std::cout << "Executed orders: " << engine.getExecutedOrders().size() << std::endl;
 }
 
+void demonstrateExchange()
+{
+    std::cout << "\n=== Multi-Agent Exchange Demo ===" << std::endl;
+
+    Market market;
+    Exchange exchange(market);
+    exchange.listSymbol("ACME", 50.0);
+
+    // Prices now come from agents trading with each other
+    exchange.addAgent(std::unique_ptr<ExchangeAgent>(new MarketMaker("MarketMaker", 500000.0)));
+    for (int i = 0; i < 8; ++i)
+    {
+        exchange.addAgent(std::unique_ptr<ExchangeAgent>(new NoiseTrader("Noise" + std::to_string(i + 1), 50000.0)));
+    }
+    exchange.addAgent(std::unique_ptr<ExchangeAgent>(new MomentumAgent("Momentum", 100000.0)));
+
+    exchange.run(500);
+    exchange.printSummary();
+}
+
+void demonstrateParameterSweep()
+{
+    std::cout << "\n=== Static Strategy Parameter Sweep ===" << std::endl;
+
+    FeeModel fees;
+    fees.setBasisPoints(1.0);
+    std::vector<double> initialPrices = {150.0, 2800.0, 300.0, 800.0, 500.0};
+    std::vector<double> vols = {0.25, 0.30, 0.20, 0.45, 0.35};
+
+    // Each run is fully inlined: no virtual calls or map lookups per tick
+    for (double threshold : {0.5, 1.0, 2.0, 4.0})
+    {
+        MomentumSignal signal;
+        signal.returnThreshold = threshold;
+        SimulationLoop<MomentumSignal, GbmStep> loop(initialPrices, 100000.0, signal, GbmStep(vols), fees);
+
+        std::mt19937 rng(7);
+        SimulationResult result = loop.run(2520, rng);
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Threshold " << threshold << "%: equity $" << result.finalEquity
+                  << ", trades " << result.trades << ", fees $" << result.totalFees
+                  << ", max drawdown " << result.maxDrawdown * 100.0 << "%" << std::endl;
+    }
+}
+
+void demonstrateWalkForward()
+{
+    std::cout << "\n=== Walk-Forward Optimization ===" << std::endl;
+
+    FeeModel fees;
+    fees.setBasisPoints(1.0);
+    std::vector<double> initialPrices = {150.0, 2800.0, 300.0, 800.0, 500.0};
+    std::vector<double> vols = {0.25, 0.30, 0.20, 0.45, 0.35};
+
+    // Prices are generated once; every candidate replays the cached path
+    std::mt19937 rng(7);
+    MarketPath path = MarketPath::generate(initialPrices, GbmStep(vols), 2520, rng);
+
+    WalkForwardConfig config;
+    config.trainSteps = 504;
+    config.testSteps = 252;
+    config.search.method = SearchMethod::BAYESIAN;
+    config.search.budget = 40;
+
+    WalkForwardOptimizer<MomentumSignal> optimizer(
+        {{"threshold", 0.25, 4.0, 0.25, false}, {"orderQty", 1.0, 50.0, 0.0, true}},
+        [](const std::vector<double> &p)
+        {
+            MomentumSignal signal;
+            signal.returnThreshold = p[0];
+            signal.orderQty = p[1];
+            return signal;
+        },
+        fees, config);
+
+    for (const WalkForwardWindow &window : optimizer.run(path))
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Train [" << window.trainStart << ", " << window.testStart << ") threshold "
+                  << window.best.parameters[0] << "%, qty " << window.best.parameters[1]
+                  << ": in-sample " << window.best.score * 100.0 << "%, out-of-sample "
+                  << window.outOfSample.score * 100.0 << "% (" << window.evaluations << " runs)" << std::endl;
+    }
+}
+
+void demonstrateDerivatives()
+{
+    std::cout << "\n=== Options and Futures ===" << std::endl;
+
+    Market market;
+    market.addSymbol("SPY", 400.0, 0.18);
+    market.addSymbol("TSLA", 800.0, 0.55);
+    Portfolio portfolio(1000000.0);
+    TradingEngine engine(market, portfolio);
+    engine.enableOrderLogging(false);
+
+    // A full chain per underlying: 5 expiries x 41 strikes x calls and puts
+    DerivativesBook book(0.03);
+    size_t atmCall = 0;
+    size_t weeklyCall = 0;
+    for (const std::string &symbol : market.getAvailableSymbols())
+    {
+        double spot = market.getCurrentPrice(symbol);
+        for (long expiry : {5L, 21L, 63L, 126L, 252L})
+        {
+            for (int k = -20; k <= 20; ++k)
+            {
+                size_t call = book.addOption(symbol, OptionRight::CALL, spot * (1.0 + 0.01 * k), expiry);
+                book.addOption(symbol, OptionRight::PUT, spot * (1.0 + 0.01 * k), expiry);
+                if (symbol == "SPY" && expiry == 63 && k == 0)
+                {
+                    atmCall = call;
+                }
+                if (symbol == "SPY" && expiry == 5 && k == 0)
+                {
+                    weeklyCall = call;
+                }
+            }
+        }
+    }
+    size_t future = book.addFuture("SPY", 63, 50.0);
+    size_t frontFuture = book.addFuture("SPY", 10, 50.0);
+    book.revalue(market);
+
+    // Positions that expire during the run and are paid out
+    book.setPosition(weeklyCall, 5);
+    book.setPosition(frontFuture, 1);
+
+    // Short an at-the-money SPY straddle, hedged with futures
+    book.setPosition(atmCall, -10);
+    book.setPosition(atmCall + 1, -10);
+    book.setPosition(future, -book.getTotals().delta / (50.0 * book.getContractGreeks(future).delta));
+
+    engine.setDerivativesBook(&book);
+    engine.runSimulation(20);
+
+    const Greeks &totals = book.getTotals();
+    std::cout << std::fixed << std::setprecision(2)
+              << book.getContractCount() << " contracts revalued every step" << std::endl
+              << "Book value: $" << totals.value << ", P&L $" << portfolio.getDerivativesPnL() << ", delta " << totals.delta << ", gamma " << totals.gamma
+              << ", vega " << totals.vega << ", theta/day " << totals.theta / 252.0 << std::endl;
+
+    // Expired contracts settled at their expiry and no longer follow SPY
+    Greeks expiredCall = book.getContractGreeks(weeklyCall);
+    Greeks expiredFuture = book.getContractGreeks(frontFuture);
+    market.updatePrices();
+    engine.markToMarket();
+    auto unchanged = [](const Greeks &a, const Greeks &b) {
+        return a.value == b.value && a.delta == b.delta && a.gamma == b.gamma && a.vega == b.vega &&
+               a.theta == b.theta && a.rho == b.rho;
+    };
+    bool frozen = book.isSettled(weeklyCall) && book.isSettled(frontFuture) &&
+                  book.getPosition(weeklyCall) == 0.0 && book.getPosition(frontFuture) == 0.0 &&
+                  unchanged(expiredCall, book.getContractGreeks(weeklyCall)) &&
+                  unchanged(expiredFuture, book.getContractGreeks(frontFuture));
+    std::cout << "Expired contracts settled and frozen: " << (frozen ? "yes" : "NO") << std::endl;
+
+    // Cross-check the straddle against Monte-Carlo on the market's GBM step.
+    // SPY's contracts were added first, so its book ids are its chain indices.
+    const OptionChain *chain = book.getOptionChain("SPY");
+    std::vector<double> mcPrices;
+    MonteCarloPricer pricer(50000);
+    pricer.price(*chain, market.getCurrentPrice("SPY"), market.getVolatility("SPY"), book.getRiskFreeRate(),
+                 market.getCurrentStep(), mcPrices);
+    std::cout << "SPY K=" << chain->getStrike(atmCall) << " call: Black-Scholes $" << chain->getPrice(atmCall)
+              << ", Monte-Carlo $" << mcPrices[atmCall] << std::endl;
+}
+
+void demonstrateMetrics()
+{
+    std::cout << "\n=== Live Metrics ===" << std::endl;
+
+    Market market;
+    market.addSymbol("AAPL", 150.0, 0.02);
+    market.addSymbol("MSFT", 300.0, 0.025);
+    Portfolio portfolio(100000.0);
+    TradingEngine engine(market, portfolio);
+    engine.enableOrderLogging(false);
+
+    // Scrape with: curl http://127.0.0.1:<port>/metrics
+    MetricsPublisher publisher;
+    MetricsExporter exporter(publisher, 0);
+    engine.setMetricsPublisher(&publisher);
+    if (exporter.start())
+    {
+        std::cout << "Serving metrics at http://127.0.0.1:" << exporter.getPort() << "/metrics" << std::endl;
+    }
+
+    engine.executeLimitOrder("AAPL", OrderType::BUY, 50, 148.0);
+    engine.executeLimitOrder("MSFT", OrderType::BUY, 20, 297.0);
+    engine.executeLimitOrder("MSFT", OrderType::SELL, 10, 310.0);
+    engine.runSimulation(20);
+
+    EngineMetrics metrics;
+    publisher.read(metrics);
+    std::cout << std::fixed << std::setprecision(2)
+              << "Snapshot: " << metrics.steps << " steps, " << metrics.fills << " fills, "
+              << metrics.restingOrders << " resting orders, equity $" << metrics.equity
+              << ", mean step " << (metrics.stepCount > 0 ? 1e6 * metrics.stepSeconds / metrics.stepCount : 0.0)
+              << " us" << std::endl;
+    exporter.stop();
+}
+
 int main(int, char **)
 {
     std::cout << "=== C++ Trading Simulation ===" << std::endl;
@@ -158,6 +369,26 @@ int main(int, char **)
                   << std::string(60, '=') << std::endl;
         demonstrateOrderManagement();
 
+        std::cout << "\n"
+                  << std::string(60, '=') << std::endl;
+        demonstrateExchange();
+
+        std::cout << "\n"
+                  << std::string(60, '=') << std::endl;
+        demonstrateParameterSweep();
+
+        std::cout << "\n"
+                  << std::string(60, '=') << std::endl;
+        demonstrateWalkForward();
+
+        std::cout << "\n"
+                  << std::string(60, '=') << std::endl;
+        demonstrateDerivatives();
+
+        std::cout << "\n"
+                  << std::string(60, '=') << std::endl;
+        demonstrateMetrics();
+
         std::cout << "\n=== Simulation Complete ===" << std::endl;
         std::cout << "All trading scenarios executed successfully!" << std::endl;
     }
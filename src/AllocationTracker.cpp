@@ -0,0 +1,60 @@
+#include "AllocationTracker.h"
+
+#ifdef TRADING_TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+
+void* countedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* countedAllocateAligned(std::size_t size, std::size_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    // aligned_alloc needs the size rounded up to the alignment
+    std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded ? rounded : alignment);
+}
+}
+
+// The array and nothrow forms forward to these in the standard library
+void* operator new(std::size_t size) {
+    void* ptr = countedAllocate(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* ptr = countedAllocateAligned(size, static_cast<std::size_t>(alignment));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+bool AllocationTracker::isEnabled() { return true; }
+uint64_t AllocationTracker::getAllocationCount() { return allocationCount.load(std::memory_order_relaxed); }
+uint64_t AllocationTracker::getAllocatedBytes() { return allocatedBytes.load(std::memory_order_relaxed); }
+
+#else
+
+bool AllocationTracker::isEnabled() { return false; }
+uint64_t AllocationTracker::getAllocationCount() { return 0; }
+uint64_t AllocationTracker::getAllocatedBytes() { return 0; }
+
+#endif
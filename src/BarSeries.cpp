@@ -0,0 +1,63 @@
+#include "BarSeries.h"
+#include <algorithm>
+
+BarSeries::BarSeries(size_t updatesPerBar, size_t barCapacity)
+    : ticksPerBar(std::max<size_t>(1, updatesPerBar)), capacity(std::max<size_t>(1, barCapacity)) {}
+
+size_t BarSeries::addSymbol() {
+    size_t index = forming.size();
+    ring.resize(ring.size() + capacity);
+    heads.push_back(0);
+    counts.push_back(0);
+    completed.push_back(0);
+    forming.emplace_back();
+    return index;
+}
+
+void BarSeries::update(size_t index, uint64_t sequence, double price, double volume) {
+    Bar& bar = forming[index];
+    uint64_t start = sequence - sequence % ticksPerBar;
+
+    // A gap in the sequence closes whatever was forming
+    if (bar.ticks > 0 && bar.start != start) {
+        publish(index);
+    }
+
+    if (bar.ticks == 0) {
+        bar.start = start;
+        bar.open = price;
+        bar.high = price;
+        bar.low = price;
+        bar.volume = 0.0;
+    } else {
+        bar.high = std::max(bar.high, price);
+        bar.low = std::min(bar.low, price);
+    }
+    bar.close = price;
+    bar.volume += volume;
+    ++bar.ticks;
+
+    // Publish on the bar's last update rather than on the first update of the next one
+    if (sequence + 1 == start + ticksPerBar) {
+        publish(index);
+    }
+}
+
+BarView BarSeries::getBars(size_t index) const {
+    return BarView(ring.data() + index * capacity, capacity, heads[index], counts[index]);
+}
+
+void BarSeries::publish(size_t index) {
+    size_t slot = heads[index] + counts[index];
+    if (slot >= capacity) {
+        slot -= capacity;
+    }
+    ring[index * capacity + slot] = forming[index];
+    if (counts[index] < capacity) {
+        ++counts[index];
+    } else {
+        heads[index] = heads[index] + 1 == capacity ? 0 : heads[index] + 1;
+    }
+    ++completed[index];
+    forming[index].ticks = 0;
+}
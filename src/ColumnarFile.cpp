@@ -0,0 +1,570 @@
+#include "ColumnarFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace {
+const char MAGIC[8] = {'T', 'C', 'O', 'L', '0', '0', '0', '2'};
+const char MAGIC_V1[8] = {'T', 'C', 'O', 'L', '0', '0', '0', '1'};    // varint XOR doubles
+const size_t MAX_PENDING_CHUNKS = 4; // bounds memory when the disk falls behind
+
+// DOUBLE chunk modes: XOR bit stream, or DECIMAL_MODE + d for values that are exact multiples of 10^-d
+const uint8_t XOR_MODE = 0;
+const uint8_t DECIMAL_MODE = 1;
+const double POW10[] = {1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6};
+const int MAX_DECIMALS = 6;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsToDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Fewest decimals d for which every value is exactly n / 10^d, or -1
+int decimalDigits(const std::vector<double>& values) {
+    for (int d = 0; d <= MAX_DECIMALS; ++d) {
+        bool exact = true;
+        for (double value : values) {
+            double scaled = value * POW10[d];
+            if (!(std::fabs(scaled) < 9007199254740992.0) ||
+                doubleBits(static_cast<double>(std::llround(scaled)) / POW10[d]) != doubleBits(value)) {
+                exact = false;
+                break;
+            }
+        }
+        if (exact) {
+            return d;
+        }
+    }
+    return -1;
+}
+
+// MSB-first bit packing for DOUBLE columns
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& output) : out(output), buffer(0), count(0) {}
+
+    // Append the low 'bits' (1..64) bits of value
+    void write(uint64_t value, int bits) {
+        if (bits > 32) {
+            write(value >> 32, bits - 32);
+            bits = 32;
+        }
+        buffer = (buffer << bits) | (value & ((uint64_t(1) << bits) - 1));
+        count += bits;
+        while (count >= 8) {
+            count -= 8;
+            out.push_back(static_cast<uint8_t>(buffer >> count));
+        }
+    }
+
+    void flush() {
+        if (count > 0) {
+            out.push_back(static_cast<uint8_t>(buffer << (8 - count)));
+            count = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t buffer;
+    int count;      // pending bits in the low end of buffer, < 8 between writes
+};
+
+struct BitReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint8_t byte;
+    int count;      // unread bits left in byte
+
+    bool read(int bits, uint64_t& value) {
+        value = 0;
+        while (bits > 0) {
+            if (count == 0) {
+                if (pos >= size) {
+                    return false;
+                }
+                byte = data[pos++];
+                count = 8;
+            }
+            int take = std::min(bits, count);
+            value = (value << take) | ((byte >> (count - take)) & ((1u << take) - 1));
+            count -= take;
+            bits -= take;
+        }
+        return true;
+    }
+};
+
+// Bounds-checked cursor over a file image
+struct Cursor {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= size) {
+                return false;
+            }
+            uint8_t byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool bytes(size_t length, std::string& out) {
+        if (length > size - pos) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return true;
+    }
+};
+}
+
+ColumnarWriter::ColumnarWriter(const std::string& path, const std::vector<ColumnSpec>& columns, size_t rowsPerChunk)
+    : schema(columns), chunkRows(rowsPerChunk > 0 ? rowsPerChunk : 1), file(std::fopen(path.c_str(), "wb")),
+      dictionaries(columns.size()), totalRows(0), maxPendingChunks(MAX_PENDING_CHUNKS), pendingCount(0), closing(false) {
+    current = takeFreeChunk();
+    if (!file) {
+        return;
+    }
+
+    std::vector<uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+    putVarint(header, schema.size());
+    for (const auto& column : schema) {
+        putVarint(header, column.name.size());
+        header.insert(header.end(), column.name.begin(), column.name.end());
+        header.push_back(static_cast<uint8_t>(column.type));
+    }
+    std::fwrite(header.data(), 1, header.size(), file);
+
+    writerThread = std::thread(&ColumnarWriter::writerLoop, this);
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    close();
+}
+
+void ColumnarWriter::appendString(size_t column, const std::string& value) {
+    auto& dictionary = dictionaries[column];
+    auto it = dictionary.find(value);
+    int64_t code;
+    if (it != dictionary.end()) {
+        code = it->second;
+    } else {
+        code = static_cast<int64_t>(dictionary.size());
+        dictionary.emplace(value, code);
+        current.columns[column].newEntries.push_back(value);
+    }
+    current.columns[column].ints.push_back(code);
+}
+
+void ColumnarWriter::endRow() {
+    if (!file) {
+        // Nothing will be written; keep the buffers from growing
+        for (auto& column : current.columns) {
+            column.ints.clear();
+            column.doubles.clear();
+            column.newEntries.clear();
+        }
+        return;
+    }
+
+    ++totalRows;
+    if (++current.rows >= chunkRows) {
+        enqueue(std::move(current));
+        current = takeFreeChunk();
+    }
+}
+
+void ColumnarWriter::flush() {
+    if (file && current.rows > 0) {
+        enqueue(std::move(current));
+        current = takeFreeChunk();
+    }
+}
+
+void ColumnarWriter::close() {
+    if (!file) {
+        return;
+    }
+
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    pendingCondition.notify_one();
+    writerThread.join();
+
+    std::fclose(file);
+    file = nullptr;
+}
+
+ColumnarWriter::Chunk ColumnarWriter::takeFreeChunk() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeChunks.empty()) {
+            Chunk chunk = std::move(freeChunks.back());
+            freeChunks.pop_back();
+            return chunk;
+        }
+    }
+
+    Chunk chunk;
+    chunk.columns.resize(schema.size());
+    for (size_t i = 0; i < schema.size(); ++i) {
+        if (schema[i].type == ColumnType::DOUBLE) {
+            chunk.columns[i].doubles.reserve(chunkRows);
+        } else {
+            chunk.columns[i].ints.reserve(chunkRows);
+        }
+    }
+    return chunk;
+}
+
+void ColumnarWriter::enqueue(Chunk&& chunk) {
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceCondition.wait(lock, [this] { return pending.size() < maxPendingChunks; });
+    pending.push_back(std::move(chunk));
+    pendingCount.store(pending.size(), std::memory_order_relaxed);
+    lock.unlock();
+    pendingCondition.notify_one();
+}
+
+void ColumnarWriter::writerLoop() {
+    while (true) {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            pendingCondition.wait(lock, [this] { return closing || !pending.empty(); });
+            if (pending.empty()) {
+                break;
+            }
+            chunk = std::move(pending.front());
+            pending.pop_front();
+            pendingCount.store(pending.size(), std::memory_order_relaxed);
+        }
+        spaceCondition.notify_one();
+
+        encodeChunk(chunk);
+        std::fwrite(encodeBuffer.data(), 1, encodeBuffer.size(), file);
+
+        // Recycle the buffers, keeping their capacity
+        chunk.rows = 0;
+        for (auto& column : chunk.columns) {
+            column.ints.clear();
+            column.doubles.clear();
+            column.newEntries.clear();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        freeChunks.push_back(std::move(chunk));
+    }
+
+    encodeBuffer.clear();
+    putVarint(encodeBuffer, 0);
+    putVarint(encodeBuffer, totalRows);
+    std::fwrite(encodeBuffer.data(), 1, encodeBuffer.size(), file);
+}
+
+void ColumnarWriter::encodeChunk(const Chunk& chunk) {
+    encodeBuffer.clear();
+    putVarint(encodeBuffer, chunk.rows);
+
+    for (size_t c = 0; c < schema.size(); ++c) {
+        const ColumnBuffer& column = chunk.columns[c];
+        columnBuffer.clear();
+
+        switch (schema[c].type) {
+            case ColumnType::INT64: {
+                int64_t previous = 0;
+                for (int64_t value : column.ints) {
+                    putVarint(columnBuffer, zigzag(value - previous));
+                    previous = value;
+                }
+                break;
+            }
+            case ColumnType::DOUBLE: {
+                // Scaled decimals when exact; the XOR stream still wins on long runs of repeats
+                int decimals = decimalDigits(column.doubles);
+                if (decimals >= 0) {
+                    columnBuffer.push_back(static_cast<uint8_t>(DECIMAL_MODE + decimals));
+                    int64_t previous = 0;
+                    for (double value : column.doubles) {
+                        int64_t scaled = std::llround(value * POW10[decimals]);
+                        putVarint(columnBuffer, zigzag(scaled - previous));
+                        previous = scaled;
+                    }
+                }
+                size_t decimalSize = columnBuffer.size();
+
+                columnBuffer.push_back(XOR_MODE);
+                BitWriter out(columnBuffer);
+                uint64_t previous = 0;
+                int leading = -1;       // no window until the first changed value
+                int trailing = 0;
+                for (size_t r = 0; r < column.doubles.size(); ++r) {
+                    uint64_t bits = doubleBits(column.doubles[r]);
+                    uint64_t delta = bits ^ previous;
+                    previous = bits;
+                    if (r == 0) {
+                        out.write(bits, 64);
+                    } else if (delta == 0) {
+                        out.write(0, 1);
+                    } else {
+                        int zerosBefore = std::min(__builtin_clzll(delta), 31);
+                        int zerosAfter = __builtin_ctzll(delta);
+                        if (leading >= 0 && zerosBefore >= leading && zerosAfter >= trailing) {
+                            out.write(2, 2);
+                            out.write(delta >> trailing, 64 - leading - trailing);
+                        } else {
+                            leading = zerosBefore;
+                            trailing = zerosAfter;
+                            int length = 64 - leading - trailing;
+                            out.write(3, 2);
+                            out.write(static_cast<uint64_t>(leading), 5);
+                            out.write(static_cast<uint64_t>(length - 1), 6);
+                            out.write(delta >> trailing, length);
+                        }
+                    }
+                }
+                out.flush();
+                if (decimals >= 0) {
+                    if (columnBuffer.size() - decimalSize < decimalSize) {
+                        columnBuffer.erase(columnBuffer.begin(), columnBuffer.begin() + decimalSize);
+                    } else {
+                        columnBuffer.resize(decimalSize);
+                    }
+                }
+                break;
+            }
+            case ColumnType::STRING: {
+                putVarint(columnBuffer, column.newEntries.size());
+                for (const auto& entry : column.newEntries) {
+                    putVarint(columnBuffer, entry.size());
+                    columnBuffer.insert(columnBuffer.end(), entry.begin(), entry.end());
+                }
+                size_t i = 0;
+                while (i < column.ints.size()) {
+                    size_t run = 1;
+                    while (i + run < column.ints.size() && column.ints[i + run] == column.ints[i]) {
+                        ++run;
+                    }
+                    putVarint(columnBuffer, static_cast<uint64_t>(column.ints[i]));
+                    putVarint(columnBuffer, run);
+                    i += run;
+                }
+                break;
+            }
+        }
+
+        encodeBuffer.push_back(static_cast<uint8_t>(schema[c].type));
+        putVarint(encodeBuffer, columnBuffer.size());
+        encodeBuffer.insert(encodeBuffer.end(), columnBuffer.begin(), columnBuffer.end());
+    }
+}
+
+bool ColumnarReader::readFile(const std::string& path, std::vector<ColumnData>& columns) {
+    columns.clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> image;
+    uint8_t block[65536];
+    size_t read;
+    while ((read = std::fread(block, 1, sizeof(block), file)) > 0) {
+        image.insert(image.end(), block, block + read);
+    }
+    std::fclose(file);
+
+    if (image.size() < sizeof(MAGIC)) {
+        return false;
+    }
+    bool varintDoubles = std::memcmp(image.data(), MAGIC_V1, sizeof(MAGIC_V1)) == 0;
+    if (!varintDoubles && std::memcmp(image.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    Cursor cursor{image.data(), image.size(), sizeof(MAGIC)};
+
+    uint64_t columnCount;
+    if (!cursor.varint(columnCount) || columnCount > image.size()) {
+        return false;
+    }
+    columns.resize(columnCount);
+    for (auto& column : columns) {
+        uint64_t length;
+        if (!cursor.varint(length) || !cursor.bytes(length, column.name) || cursor.pos >= cursor.size) {
+            return false;
+        }
+        column.type = static_cast<ColumnType>(cursor.data[cursor.pos++]);
+    }
+
+    std::vector<std::vector<std::string>> dictionaries(columns.size());
+    while (true) {
+        uint64_t rows;
+        if (!cursor.varint(rows)) {
+            return false;
+        }
+        if (rows == 0) {
+            uint64_t totalRows;
+            return cursor.varint(totalRows);
+        }
+
+        for (size_t c = 0; c < columns.size(); ++c) {
+            ColumnData& column = columns[c];
+            uint64_t length;
+            if (cursor.pos >= cursor.size || cursor.data[cursor.pos++] != static_cast<uint8_t>(column.type) ||
+                !cursor.varint(length) || length > cursor.size - cursor.pos) {
+                return false;
+            }
+            Cursor payload{cursor.data, cursor.pos + length, cursor.pos};
+            cursor.pos += length;
+
+            uint64_t value;
+            switch (column.type) {
+                case ColumnType::INT64: {
+                    int64_t previous = 0;
+                    for (uint64_t r = 0; r < rows; ++r) {
+                        if (!payload.varint(value)) {
+                            return false;
+                        }
+                        previous += unzigzag(value);
+                        column.ints.push_back(previous);
+                    }
+                    break;
+                }
+                case ColumnType::DOUBLE: {
+                    uint64_t previous = 0;
+                    if (varintDoubles) {
+                        for (uint64_t r = 0; r < rows; ++r) {
+                            if (!payload.varint(value)) {
+                                return false;
+                            }
+                            previous ^= value;
+                            column.doubles.push_back(bitsToDouble(previous));
+                        }
+                        break;
+                    }
+
+                    if (payload.pos >= payload.size) {
+                        return false;
+                    }
+                    uint8_t mode = payload.data[payload.pos++];
+                    if (mode != XOR_MODE) {
+                        if (mode > DECIMAL_MODE + MAX_DECIMALS) {
+                            return false;
+                        }
+                        double scale = POW10[mode - DECIMAL_MODE];
+                        int64_t scaled = 0;
+                        for (uint64_t r = 0; r < rows; ++r) {
+                            if (!payload.varint(value)) {
+                                return false;
+                            }
+                            scaled += unzigzag(value);
+                            column.doubles.push_back(static_cast<double>(scaled) / scale);
+                        }
+                        break;
+                    }
+
+                    BitReader in{payload.data, payload.size, payload.pos, 0, 0};
+                    int leading = -1;   // no window until one is sent
+                    int trailing = 0;
+                    for (uint64_t r = 0; r < rows; ++r) {
+                        if (r == 0) {
+                            if (!in.read(64, previous)) {
+                                return false;
+                            }
+                        } else {
+                            uint64_t control;
+                            if (!in.read(1, control)) {
+                                return false;
+                            }
+                            if (control != 0) {
+                                if (!in.read(1, control)) {
+                                    return false;
+                                }
+                                if (control != 0) {
+                                    uint64_t zerosBefore;
+                                    uint64_t length;
+                                    if (!in.read(5, zerosBefore) || !in.read(6, length) ||
+                                        zerosBefore + length + 1 > 64) {
+                                        return false;
+                                    }
+                                    leading = static_cast<int>(zerosBefore);
+                                    trailing = 64 - leading - static_cast<int>(length + 1);
+                                } else if (leading < 0) {
+                                    return false;
+                                }
+                                if (!in.read(64 - leading - trailing, value)) {
+                                    return false;
+                                }
+                                previous ^= value << trailing;
+                            }
+                        }
+                        column.doubles.push_back(bitsToDouble(previous));
+                    }
+                    break;
+                }
+                case ColumnType::STRING: {
+                    std::vector<std::string>& dictionary = dictionaries[c];
+                    uint64_t newEntries;
+                    if (!payload.varint(newEntries)) {
+                        return false;
+                    }
+                    for (uint64_t e = 0; e < newEntries; ++e) {
+                        std::string entry;
+                        if (!payload.varint(value) || !payload.bytes(value, entry)) {
+                            return false;
+                        }
+                        dictionary.push_back(std::move(entry));
+                    }
+                    uint64_t decoded = 0;
+                    while (decoded < rows) {
+                        uint64_t run;
+                        if (!payload.varint(value) || !payload.varint(run) || value >= dictionary.size() ||
+                            run == 0 || run > rows - decoded) {
+                            return false;
+                        }
+                        column.strings.insert(column.strings.end(), run, dictionary[value]);
+                        decoded += run;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+    }
+}
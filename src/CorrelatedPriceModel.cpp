@@ -0,0 +1,224 @@
+#include "CorrelatedPriceModel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t BLOCK_SIZE = 64; // rows/cols per tile: a 64-wide slice of x stays in L1
+}
+
+CorrelatedPriceModel::CorrelatedPriceModel(size_t symbolCount)
+    : numSymbols(symbolCount), mode(Mode::INDEPENDENT), numFactors(0),
+      jumpIntensity(0.0), jumpMean(0.0), jumpVolatility(0.0),
+      currentRegime(0), normalDist(0.0, 1.0), uniformDist(0.0, 1.0) {}
+
+bool CorrelatedPriceModel::isActive() const {
+    return mode != Mode::INDEPENDENT || jumpIntensity > 0.0 || regimeVolMultiplier.size() > 1;
+}
+
+bool CorrelatedPriceModel::setCorrelationMatrix(const std::vector<double>& correlation) {
+    if (correlation.size() != numSymbols * numSymbols) {
+        return false;
+    }
+    std::vector<double> factor;
+    if (!choleskyDecompose(correlation, numSymbols, factor)) {
+        return false;
+    }
+    lower.swap(factor);
+    draws.assign(numSymbols, 0.0);
+    mode = Mode::CHOLESKY;
+    return true;
+}
+
+bool CorrelatedPriceModel::setFactorModel(const std::vector<double>& factorLoadings, size_t factorCount) {
+    if (factorCount == 0 || factorLoadings.size() != numSymbols * factorCount) {
+        return false;
+    }
+
+    // Idiosyncratic part tops each symbol's variance up to one
+    std::vector<double> idio(numSymbols);
+    for (size_t i = 0; i < numSymbols; ++i) {
+        double systematic = 0.0;
+        for (size_t k = 0; k < factorCount; ++k) {
+            double b = factorLoadings[i * factorCount + k];
+            systematic += b * b;
+        }
+        if (systematic > 1.0) {
+            return false;
+        }
+        idio[i] = std::sqrt(1.0 - systematic);
+    }
+
+    numFactors = factorCount;
+    loadings = factorLoadings;
+    idiosyncratic.swap(idio);
+    draws.assign(numFactors, 0.0);
+    mode = Mode::FACTOR;
+    return true;
+}
+
+void CorrelatedPriceModel::setJumpModel(double intensity, double meanLogJump, double logJumpVolatility) {
+    jumpIntensity = std::max(0.0, intensity);
+    jumpMean = meanLogJump;
+    jumpVolatility = std::max(0.0, logJumpVolatility);
+}
+
+bool CorrelatedPriceModel::setRegimeSwitching(const std::vector<double>& volMultipliers,
+                                              const std::vector<double>& transition) {
+    size_t regimes = volMultipliers.size();
+    if (regimes == 0 || transition.size() != regimes * regimes) {
+        return false;
+    }
+    for (size_t r = 0; r < regimes; ++r) {
+        double rowSum = 0.0;
+        for (size_t c = 0; c < regimes; ++c) {
+            if (transition[r * regimes + c] < 0.0) {
+                return false;
+            }
+            rowSum += transition[r * regimes + c];
+        }
+        if (std::abs(rowSum - 1.0) > 1e-9) {
+            return false;
+        }
+    }
+
+    regimeVolMultiplier = volMultipliers;
+    regimeTransition = transition;
+    currentRegime = 0;
+    return true;
+}
+
+double CorrelatedPriceModel::getVolMultiplier() const {
+    return regimeVolMultiplier.empty() ? 1.0 : regimeVolMultiplier[currentRegime];
+}
+
+void CorrelatedPriceModel::generate(std::mt19937& rng, double dt, std::vector<double>& shocks,
+                                    std::vector<double>& jumps) {
+    shocks.resize(numSymbols);
+    jumps.assign(numSymbols, 0.0);
+
+    advanceRegime(rng);
+
+    switch (mode) {
+        case Mode::INDEPENDENT:
+            for (size_t i = 0; i < numSymbols; ++i) {
+                shocks[i] = normalDist(rng);
+            }
+            break;
+        case Mode::CHOLESKY:
+            for (size_t i = 0; i < numSymbols; ++i) {
+                draws[i] = normalDist(rng);
+            }
+            lowerTriangularMultiply(lower, numSymbols, draws.data(), shocks.data());
+            break;
+        case Mode::FACTOR:
+            for (size_t k = 0; k < numFactors; ++k) {
+                draws[k] = normalDist(rng);
+            }
+            for (size_t i = 0; i < numSymbols; ++i) {
+                const double* row = &loadings[i * numFactors];
+                double systematic = 0.0;
+                for (size_t k = 0; k < numFactors; ++k) {
+                    systematic += row[k] * draws[k];
+                }
+                shocks[i] = systematic + idiosyncratic[i] * normalDist(rng);
+            }
+            break;
+    }
+
+    double multiplier = getVolMultiplier();
+    if (multiplier != 1.0) {
+        for (size_t i = 0; i < numSymbols; ++i) {
+            shocks[i] *= multiplier;
+        }
+    }
+
+    if (jumpIntensity > 0.0) {
+        // Poisson jump count by inversion; almost always zero, so this is cheap
+        double lambda = jumpIntensity * dt;
+        double probZero = std::exp(-lambda);
+        for (size_t i = 0; i < numSymbols; ++i) {
+            double u = uniformDist(rng);
+            if (u <= probZero) {
+                continue;
+            }
+            int count = 0;
+            double prob = probZero;
+            double cdf = probZero;
+            while (u > cdf && count < 100) {
+                ++count;
+                prob *= lambda / count;
+                cdf += prob;
+            }
+            jumps[i] = count * jumpMean + std::sqrt(static_cast<double>(count)) * jumpVolatility * normalDist(rng);
+        }
+    }
+}
+
+bool CorrelatedPriceModel::choleskyDecompose(const std::vector<double>& matrix, size_t n,
+                                             std::vector<double>& result) {
+    if (matrix.size() != n * n) {
+        return false;
+    }
+    std::vector<double> L(n * n, 0.0);
+
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            double sum = matrix[i * n + j];
+            const double* rowI = &L[i * n];
+            const double* rowJ = &L[j * n];
+            for (size_t k = 0; k < j; ++k) {
+                sum -= rowI[k] * rowJ[k];
+            }
+            if (i == j) {
+                if (sum <= 0.0) {
+                    return false; // Not positive definite
+                }
+                L[i * n + i] = std::sqrt(sum);
+            } else {
+                L[i * n + j] = sum / L[j * n + j];
+            }
+        }
+    }
+
+    result.swap(L);
+    return true;
+}
+
+void CorrelatedPriceModel::lowerTriangularMultiply(const std::vector<double>& L, size_t n,
+                                                   const double* x, double* y) {
+    std::fill(y, y + n, 0.0);
+
+    for (size_t ib = 0; ib < n; ib += BLOCK_SIZE) {
+        size_t iEnd = std::min(ib + BLOCK_SIZE, n);
+        for (size_t jb = 0; jb <= ib; jb += BLOCK_SIZE) {
+            size_t jEnd = std::min(jb + BLOCK_SIZE, n);
+            for (size_t i = ib; i < iEnd; ++i) {
+                const double* row = &L[i * n];
+                size_t jMax = std::min(jEnd, i + 1);
+                double acc = 0.0;
+                for (size_t j = jb; j < jMax; ++j) {
+                    acc += row[j] * x[j];
+                }
+                y[i] += acc;
+            }
+        }
+    }
+}
+
+void CorrelatedPriceModel::advanceRegime(std::mt19937& rng) {
+    size_t regimes = regimeVolMultiplier.size();
+    if (regimes < 2) {
+        return;
+    }
+    double u = uniformDist(rng);
+    double cdf = 0.0;
+    const double* row = &regimeTransition[currentRegime * regimes];
+    for (size_t r = 0; r < regimes; ++r) {
+        cdf += row[r];
+        if (u < cdf) {
+            currentRegime = r;
+            return;
+        }
+    }
+    currentRegime = regimes - 1;
+}
@@ -0,0 +1,164 @@
+#include "CrossSectionalSignals.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+void CrossSectionalSignals::rank(const std::vector<double> &values, std::vector<double> &out)
+{
+    size_t n = values.size();
+    out.resize(n);
+    if (n == 0)
+    {
+        return;
+    }
+    if (n == 1)
+    {
+        out[0] = 0.5;
+        return;
+    }
+
+    order.resize(n);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(),
+              [&values](size_t a, size_t b) { return values[a] < values[b]; });
+
+    double scale = 1.0 / static_cast<double>(n - 1);
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t j = i + 1;
+        while (j < n && values[order[j]] == values[order[i]])
+        {
+            ++j;
+        }
+        double averageRank = 0.5 * static_cast<double>(i + j - 1) * scale;
+        for (size_t k = i; k < j; ++k)
+        {
+            out[order[k]] = averageRank;
+        }
+        i = j;
+    }
+}
+
+void CrossSectionalSignals::zscore(const std::vector<double> &values, std::vector<double> &out) const
+{
+    size_t n = values.size();
+    out.resize(n);
+    if (n == 0)
+    {
+        return;
+    }
+
+    const double *in = values.data();
+    double sum = 0.0;
+    double sumSq = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum += in[i];
+        sumSq += in[i] * in[i];
+    }
+    double mean = sum / static_cast<double>(n);
+    double var = std::max(0.0, sumSq / static_cast<double>(n) - mean * mean);
+    double invStd = (var > 0.0) ? 1.0 / std::sqrt(var) : 0.0;
+
+    double *dst = out.data();
+    for (size_t i = 0; i < n; ++i)
+    {
+        dst[i] = (in[i] - mean) * invStd;
+    }
+}
+
+void CrossSectionalSignals::demean(const std::vector<double> &values, std::vector<double> &out) const
+{
+    size_t n = values.size();
+    out.resize(n);
+    if (n == 0)
+    {
+        return;
+    }
+
+    const double *in = values.data();
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum += in[i];
+    }
+    double mean = sum / static_cast<double>(n);
+
+    double *dst = out.data();
+    for (size_t i = 0; i < n; ++i)
+    {
+        dst[i] = in[i] - mean;
+    }
+}
+
+void CrossSectionalSignals::sectorNeutralize(const std::vector<double> &values, const std::vector<int> &sectors,
+                                             std::vector<double> &out)
+{
+    size_t n = values.size();
+    out.resize(n);
+    if (n == 0 || sectors.size() != n)
+    {
+        std::copy(values.begin(), values.end(), out.begin());
+        return;
+    }
+
+    // Bucket 0 collects symbols without a sector (negative id)
+    int maxSector = *std::max_element(sectors.begin(), sectors.end());
+    size_t buckets = static_cast<size_t>(std::max(maxSector, -1) + 2);
+    sectorSum.assign(buckets, 0.0);
+    sectorCount.assign(buckets, 0.0);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t b = static_cast<size_t>(std::max(sectors[i], -1) + 1);
+        sectorSum[b] += values[i];
+        sectorCount[b] += 1.0;
+    }
+    for (size_t b = 0; b < buckets; ++b)
+    {
+        if (sectorCount[b] > 0.0)
+        {
+            sectorSum[b] /= sectorCount[b];
+        }
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t b = static_cast<size_t>(std::max(sectors[i], -1) + 1);
+        out[i] = values[i] - sectorSum[b];
+    }
+}
+
+void CrossSectionalSignals::topK(const std::vector<double> &values, size_t k, std::vector<size_t> &out)
+{
+    selectK(values, k, true, out);
+}
+
+void CrossSectionalSignals::bottomK(const std::vector<double> &values, size_t k, std::vector<size_t> &out)
+{
+    selectK(values, k, false, out);
+}
+
+void CrossSectionalSignals::selectK(const std::vector<double> &values, size_t k, bool largest,
+                                    std::vector<size_t> &out)
+{
+    size_t n = values.size();
+    k = std::min(k, n);
+    out.clear();
+    if (k == 0)
+    {
+        return;
+    }
+
+    order.resize(n);
+    std::iota(order.begin(), order.end(), size_t(0));
+    auto better = [&values, largest](size_t a, size_t b) {
+        return largest ? values[a] > values[b] : values[a] < values[b];
+    };
+    if (k < n)
+    {
+        std::nth_element(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k), order.end(), better);
+    }
+    std::sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k), better);
+    out.assign(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k));
+}
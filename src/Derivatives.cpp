@@ -0,0 +1,573 @@
+#include "Derivatives.h"
+#include "Market.h"
+#include "SimulationLoop.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+const double LN2 = 0.6931471805599453;
+const double LN2_HI = 6.93147180369123816490e-01;   // LN2 split so k * LN2_HI is exact
+const double LN2_LO = 1.90821492927058770002e-10;
+const double LOG2E = 1.4426950408889634;
+const double SQRT2 = 1.4142135623730951;
+const double SQRT_TWO_PI = 2.5066282746310002;
+const double ROUND_SHIFTER = 6755399441055744.0;    // 1.5 * 2^52: adding it rounds to an integer
+const double EXPONENT_SHIFTER = 4503599627370496.0; // 2^52
+const double MIN_YEARS = 1e-12;
+const double MIN_VOL = 1e-8;
+
+// The approximations below are written so that GCC can inline and vectorize
+// them inside the chain loop: no calls, no branches, integer work only on
+// 64-bit lanes.
+
+inline uint64_t toBits(double x) {
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+inline double fromBits(uint64_t bits) {
+    double x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// e^x to ~1e-15 relative; arguments are clamped to [-700, 700]
+inline double fastExp(double x) {
+    x = std::min(700.0, std::max(-700.0, x));
+    double shifted = x * LOG2E + ROUND_SHIFTER;
+    uint64_t k = toBits(shifted);       // low mantissa bits hold round(x / ln 2)
+    double kd = shifted - ROUND_SHIFTER;
+    double r = x - kd * LN2_HI - kd * LN2_LO;
+    double p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120 + r * (1.0 / 720
+        + r * (1.0 / 5040 + r * (1.0 / 40320 + r * (1.0 / 362880 + r * (1.0 / 3628800 + r / 39916800))))))))));
+    return p * fromBits((k + 1023) << 52);
+}
+
+// ln x to ~1e-15 for positive normal x
+inline double fastLog(double x) {
+    uint64_t bits = toBits(x);
+    double exponent = fromBits((bits >> 52) | toBits(EXPONENT_SHIFTER)) - EXPONENT_SHIFTER - 1023.0;
+    double m = fromBits((bits & 0x000FFFFFFFFFFFFFULL) | toBits(1.0));
+    bool high = m > SQRT2;
+    m = high ? m * 0.5 : m;
+    exponent = high ? exponent + 1.0 : exponent;
+    // ln m = 2 atanh(s), |s| <= 0.172
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double series = 1.0 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 * (1.0 / 9 + s2 * (1.0 / 11
+        + s2 * (1.0 / 13 + s2 * (1.0 / 15 + s2 * (1.0 / 17 + s2 / 19))))))));
+    return exponent * LN2 + 2.0 * s * series;
+}
+
+// Standard normal CDF given the density factor e^(-x^2/2): Hart's
+// double-precision rational approximation (~1e-14), with a continued fraction
+// beyond 5 * sqrt(2) standard deviations. Both branches are folded into one
+// numerator/denominator pair so each call costs a single division.
+inline double normCdf(double x, double gaussian) {
+    double z = std::fabs(x);
+
+    double nearNumerator = 3.52624965998911e-02 * z + 0.700383064443688;
+    nearNumerator = nearNumerator * z + 6.37396220353165;
+    nearNumerator = nearNumerator * z + 33.912866078383;
+    nearNumerator = nearNumerator * z + 112.079291497871;
+    nearNumerator = nearNumerator * z + 221.213596169931;
+    nearNumerator = nearNumerator * z + 220.206867912376;
+    double nearDenominator = 8.83883476483184e-02 * z + 1.75566716318264;
+    nearDenominator = nearDenominator * z + 16.064177579207;
+    nearDenominator = nearDenominator * z + 86.7807322029461;
+    nearDenominator = nearDenominator * z + 296.564248779674;
+    nearDenominator = nearDenominator * z + 637.333633378831;
+    nearDenominator = nearDenominator * z + 793.826512519948;
+    nearDenominator = nearDenominator * z + 440.413735824752;
+
+    // z + 1/(z + 2/(z + 3/(z + 4/(z + 0.65)))) as p4 / p3
+    double p0 = z + 0.65;
+    double p1 = z * p0 + 4.0;
+    double p2 = z * p1 + 3.0 * p0;
+    double p3 = z * p2 + 2.0 * p1;
+    double p4 = z * p3 + p2;
+
+    bool near = z < 7.07106781186547;
+    double numerator = near ? nearNumerator : p3;
+    double denominator = near ? nearDenominator : p4 * SQRT_TWO_PI;
+    double tail = z > 37.0 ? 0.0 : gaussian * numerator / denominator;
+    return x > 0.0 ? 1.0 - tail : tail;
+}
+
+// GCC on x86-64 Linux also builds an AVX2/FMA (x86-64-v3) copy of the chain
+// kernel and picks one at load time, so default builds run 4-wide where the
+// CPU allows. flatten makes sure the helpers are inlined into both copies.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define CHAIN_KERNEL_CLONES __attribute__((flatten, target_clones("arch=x86-64-v3", "default")))
+#else
+#define CHAIN_KERNEL_CLONES
+#endif
+
+// Black-Scholes over a whole chain. Puts are priced from the call by parity,
+// so the only per-contract selects are on the call flag and on expiry. The
+// arrays never overlap; __restrict lets GCC vectorize without versioning the
+// loop for every input/output pair.
+CHAIN_KERNEL_CLONES
+void blackScholesChain(size_t count, double spot, double vol, double rate, double step,
+                       const double* __restrict strikes, const double* __restrict expiries,
+                       const double* __restrict callFlags, const double* __restrict impliedVols,
+                       double* __restrict prices, double* __restrict deltas, double* __restrict gammas,
+                       double* __restrict vegas, double* __restrict thetas, double* __restrict rhos) {
+    double logSpot = std::log(spot);
+    double inverseSpot = 1.0 / spot;
+    for (size_t i = 0; i < count; ++i) {
+        double strike = strikes[i];
+        double isPut = 1.0 - callFlags[i];
+        double years = (expiries[i] - step) * YEARS_PER_STEP;
+        double sigma = std::max(impliedVols[i] > 0.0 ? impliedVols[i] : vol, MIN_VOL);
+        double t = std::max(years, MIN_YEARS);
+
+        double sqrtT = std::sqrt(t);
+        double sigmaSqrtT = sigma * sqrtT;
+        double inverseSigmaSqrtT = 1.0 / sigmaSqrtT;
+        double d1 = (logSpot - fastLog(strike) + (rate + 0.5 * sigma * sigma) * t) * inverseSigmaSqrtT;
+        double d2 = d1 - sigmaSqrtT;
+        double discountedStrike = strike * fastExp(-rate * t);
+        double gaussian1 = fastExp(-0.5 * d1 * d1);
+        double gaussian2 = gaussian1 * spot / discountedStrike;    // e^(-d2^2/2), by the definition of d2
+        double nd1 = normCdf(d1, gaussian1);
+        double nd2 = normCdf(d2, gaussian2);
+        double density = gaussian1 * (1.0 / SQRT_TWO_PI);
+
+        double price = spot * nd1 - discountedStrike * nd2 - isPut * (spot - discountedStrike);
+        double delta = nd1 - isPut;
+        double gamma = density * inverseSpot * inverseSigmaSqrtT;
+        double vega = spot * density * sqrtT;
+        double theta = -0.5 * spot * density * sigma * sigma * inverseSigmaSqrtT
+                       - rate * discountedStrike * (nd2 - isPut);
+        double rho = discountedStrike * t * (nd2 - isPut);
+
+        // At and after expiry the contract is worth its intrinsic value
+        bool live = years > 0.0;
+        double intrinsic = std::max(isPut > 0.0 ? strike - spot : spot - strike, 0.0);
+        double exercised = isPut > 0.0 ? (spot < strike ? -1.0 : 0.0) : (spot > strike ? 1.0 : 0.0);
+        prices[i] = live ? price : intrinsic;
+        deltas[i] = live ? delta : exercised;
+        gammas[i] = live ? gamma : 0.0;
+        vegas[i] = live ? vega : 0.0;
+        thetas[i] = live ? theta : 0.0;
+        rhos[i] = live ? rho : 0.0;
+    }
+}
+}
+
+Greeks& Greeks::operator+=(const Greeks& other) {
+    value += other.value;
+    delta += other.delta;
+    gamma += other.gamma;
+    vega += other.vega;
+    theta += other.theta;
+    rho += other.rho;
+    return *this;
+}
+
+Greeks& Greeks::operator-=(const Greeks& other) {
+    value -= other.value;
+    delta -= other.delta;
+    gamma -= other.gamma;
+    vega -= other.vega;
+    theta -= other.theta;
+    rho -= other.rho;
+    return *this;
+}
+
+Greeks blackScholes(OptionRight right, double spot, double strike, double years, double vol, double rate) {
+    Greeks greeks;
+    bool call = right == OptionRight::CALL;
+    if (years <= 0.0) {
+        greeks.value = std::max(call ? spot - strike : strike - spot, 0.0);
+        greeks.delta = call ? (spot > strike ? 1.0 : 0.0) : (spot < strike ? -1.0 : 0.0);
+        return greeks;
+    }
+
+    double sigma = std::max(vol, MIN_VOL);
+    double sqrtT = std::sqrt(years);
+    double d1 = (std::log(spot / strike) + (rate + 0.5 * sigma * sigma) * years) / (sigma * sqrtT);
+    double d2 = d1 - sigma * sqrtT;
+    double nd1 = 0.5 * std::erfc(-d1 / SQRT2);
+    double nd2 = 0.5 * std::erfc(-d2 / SQRT2);
+    double density = std::exp(-0.5 * d1 * d1) / SQRT_TWO_PI;
+    double discountedStrike = strike * std::exp(-rate * years);
+
+    greeks.gamma = density / (spot * sigma * sqrtT);
+    greeks.vega = spot * density * sqrtT;
+    if (call) {
+        greeks.value = spot * nd1 - discountedStrike * nd2;
+        greeks.delta = nd1;
+        greeks.theta = -spot * density * sigma / (2.0 * sqrtT) - rate * discountedStrike * nd2;
+        greeks.rho = discountedStrike * years * nd2;
+    } else {
+        greeks.value = discountedStrike * (1.0 - nd2) - spot * (1.0 - nd1);
+        greeks.delta = nd1 - 1.0;
+        greeks.theta = -spot * density * sigma / (2.0 * sqrtT) + rate * discountedStrike * (1.0 - nd2);
+        greeks.rho = -discountedStrike * years * (1.0 - nd2);
+    }
+    return greeks;
+}
+
+size_t OptionChain::addOption(OptionRight right, double strike, long expiryStep, double multiplier,
+                              double impliedVol) {
+    strikes.push_back(strike);
+    expiries.push_back(static_cast<double>(expiryStep));
+    callFlags.push_back(right == OptionRight::CALL ? 1.0 : 0.0);
+    impliedVols.push_back(impliedVol);
+    multipliers.push_back(multiplier);
+    positions.push_back(0.0);
+    prices.push_back(0.0);
+    deltas.push_back(0.0);
+    gammas.push_back(0.0);
+    vegas.push_back(0.0);
+    thetas.push_back(0.0);
+    rhos.push_back(0.0);
+    settled.push_back(0);
+    settlementPrices.push_back(0.0);
+    nextExpiry = std::min(nextExpiry, expiryStep);
+    return strikes.size() - 1;
+}
+
+double OptionChain::revalue(double spot, double vol, double rate, long step) {
+    size_t count = size();
+    blackScholesChain(count, spot, vol, rate, static_cast<double>(step), strikes.data(), expiries.data(),
+                      callFlags.data(), impliedVols.data(), prices.data(), deltas.data(), gammas.data(),
+                      vegas.data(), thetas.data(), rhos.data());
+    double payout = settleExpired(step);
+
+    totals = Greeks();
+    for (size_t i = 0; i < count; ++i) {
+        double units = positions[i] * multipliers[i];
+        totals.value += units * prices[i];
+        totals.delta += units * deltas[i];
+        totals.gamma += units * gammas[i];
+        totals.vega += units * vegas[i];
+        totals.theta += units * thetas[i];
+        totals.rho += units * rhos[i];
+    }
+    return payout;
+}
+
+double OptionChain::settleExpired(long step) {
+    // The kernel prices every contract; settled ones are put back to their fixed payoff
+    double payout = 0.0;
+    if (step >= nextExpiry) {
+        nextExpiry = std::numeric_limits<long>::max();
+        for (size_t i = 0; i < size(); ++i) {
+            if (settled[i]) {
+                continue;
+            }
+            if (getExpiryStep(i) > step) {
+                nextExpiry = std::min(nextExpiry, getExpiryStep(i));
+                continue;
+            }
+            // prices[i] is the intrinsic value at this first spot on or after expiry
+            settled[i] = 1;
+            settlementPrices[i] = prices[i];
+            payout += positions[i] * multipliers[i] * prices[i];
+            positions[i] = 0.0;
+            ++settledCount;
+        }
+    }
+    if (settledCount > 0) {
+        for (size_t i = 0; i < size(); ++i) {
+            if (settled[i]) {
+                prices[i] = settlementPrices[i];
+                deltas[i] = 0.0;
+                gammas[i] = 0.0;
+                vegas[i] = 0.0;
+                thetas[i] = 0.0;
+                rhos[i] = 0.0;
+            }
+        }
+    }
+    return payout;
+}
+
+void OptionChain::setPosition(size_t index, double quantity) {
+    if (settled[index]) {
+        return;
+    }
+    double units = (quantity - positions[index]) * multipliers[index];
+    positions[index] = quantity;
+    totals.value += units * prices[index];
+    totals.delta += units * deltas[index];
+    totals.gamma += units * gammas[index];
+    totals.vega += units * vegas[index];
+    totals.theta += units * thetas[index];
+    totals.rho += units * rhos[index];
+}
+
+Greeks OptionChain::getGreeks(size_t index) const {
+    Greeks greeks;
+    greeks.value = prices[index];
+    greeks.delta = deltas[index];
+    greeks.gamma = gammas[index];
+    greeks.vega = vegas[index];
+    greeks.theta = thetas[index];
+    greeks.rho = rhos[index];
+    return greeks;
+}
+
+size_t FuturesCurve::addFuture(long expiryStep, double multiplier) {
+    expiries.push_back(static_cast<double>(expiryStep));
+    multipliers.push_back(multiplier);
+    positions.push_back(0.0);
+    costBasis.push_back(0.0);
+    marks.push_back(0.0);
+    deltas.push_back(0.0);
+    rhos.push_back(0.0);
+    settled.push_back(0);
+    return expiries.size() - 1;
+}
+
+double FuturesCurve::revalue(double spot, double rate, long step) {
+    totals = Greeks();
+    double variationMargin = 0.0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (settled[i]) {
+            continue;
+        }
+        double years = std::max(0.0, (expiries[i] - static_cast<double>(step)) * YEARS_PER_STEP);
+        double carry = std::exp(rate * years);
+        marks[i] = spot * carry;
+        deltas[i] = carry;
+        rhos[i] = marks[i] * years;
+
+        double units = positions[i] * multipliers[i];
+        variationMargin += units * marks[i] - costBasis[i];
+        costBasis[i] = units * marks[i];
+        if (years <= 0.0) {
+            // Final margin paid at the first spot on or after expiry; the mark stays there
+            settled[i] = 1;
+            positions[i] = 0.0;
+            costBasis[i] = 0.0;
+            deltas[i] = 0.0;
+            rhos[i] = 0.0;
+            continue;
+        }
+        totals.delta += units * deltas[i];
+        totals.rho += units * rhos[i];
+    }
+    return variationMargin;
+}
+
+void FuturesCurve::setPosition(size_t index, double quantity) {
+    if (settled[index]) {
+        return;
+    }
+    double units = (quantity - positions[index]) * multipliers[index];
+    positions[index] = quantity;
+    costBasis[index] += units * marks[index];
+    totals.delta += units * deltas[index];
+    totals.rho += units * rhos[index];
+}
+
+Greeks FuturesCurve::getGreeks(size_t index) const {
+    Greeks greeks;
+    greeks.value = marks[index];
+    greeks.delta = deltas[index];
+    greeks.rho = rhos[index];
+    return greeks;
+}
+
+MonteCarloPricer::MonteCarloPricer(size_t paths, unsigned int seed, bool antitheticVariates)
+    : pathCount(std::max<size_t>(2, paths)), antithetic(antitheticVariates), rng(seed), normalDist(0.0, 1.0) {}
+
+void MonteCarloPricer::price(const OptionChain& chain, double spot, double vol, double rate, long step,
+                             std::vector<double>& out, std::vector<double>* standardErrors) {
+    size_t count = chain.size();
+    out.assign(count, 0.0);
+    if (standardErrors) {
+        standardErrors->assign(count, 0.0);
+    }
+
+    byExpiry.resize(count);
+    std::iota(byExpiry.begin(), byExpiry.end(), 0);
+    std::stable_sort(byExpiry.begin(), byExpiry.end(), [&](size_t a, size_t b) {
+        return chain.getExpiryStep(a) < chain.getExpiryStep(b);
+    });
+
+    paths.assign(pathCount, spot);
+    returns.resize(pathCount);
+    shocks.resize(pathCount);
+    vols.assign(pathCount, vol);
+    size_t half = antithetic ? pathCount / 2 : 0;
+
+    long current = step;
+    size_t next = 0;
+    while (next < count) {
+        // Advance every path to the next expiry, then settle all contracts expiring there
+        long expiry = chain.getExpiryStep(byExpiry[next]);
+        for (; current < expiry; ++current) {
+            for (size_t p = 0; p < half; ++p) {
+                shocks[p] = normalDist(rng);
+                shocks[p + half] = -shocks[p];
+            }
+            for (size_t p = 2 * half; p < pathCount; ++p) {
+                shocks[p] = normalDist(rng);
+            }
+            GbmStep::applyShocks(paths.data(), returns.data(), pathCount, vols.data(), shocks.data(), nullptr,
+                                 rate, YEARS_PER_STEP);
+        }
+
+        double discount = std::exp(-rate * static_cast<double>(current - step) * YEARS_PER_STEP);
+        for (; next < count && chain.getExpiryStep(byExpiry[next]) <= current; ++next) {
+            size_t contract = byExpiry[next];
+            double strike = chain.getStrike(contract);
+            double sign = chain.getRight(contract) == OptionRight::CALL ? 1.0 : -1.0;
+            double sum = 0.0;
+            double sumSquares = 0.0;
+            for (size_t p = 0; p < pathCount; ++p) {
+                double payoff = std::max(sign * (paths[p] - strike), 0.0);
+                sum += payoff;
+                sumSquares += payoff * payoff;
+            }
+            double mean = sum / static_cast<double>(pathCount);
+            out[contract] = discount * mean;
+            if (standardErrors) {
+                // Treats paths as independent, so conservative with antithetic pairs
+                double variance = std::max(0.0, sumSquares / static_cast<double>(pathCount) - mean * mean);
+                (*standardErrors)[contract] = discount * std::sqrt(variance / static_cast<double>(pathCount));
+            }
+        }
+    }
+}
+
+size_t DerivativesBook::addOption(const std::string& underlying, OptionRight right, double strike,
+                                  long expiryStep, double multiplier, double impliedVol) {
+    Underlying& target = underlyingFor(underlying);
+    size_t index = target.options.addOption(right, strike, expiryStep, multiplier, impliedVol);
+    contracts.push_back({static_cast<uint32_t>(&target - underlyings.data()), static_cast<uint32_t>(index), false});
+    if (target.lastSpot > 0.0) {
+        revalueUnderlying(target, target.lastSpot, target.lastVol, target.lastStep);
+    }
+    return contracts.size() - 1;
+}
+
+size_t DerivativesBook::addFuture(const std::string& underlying, long expiryStep, double multiplier) {
+    Underlying& target = underlyingFor(underlying);
+    size_t index = target.futures.addFuture(expiryStep, multiplier);
+    contracts.push_back({static_cast<uint32_t>(&target - underlyings.data()), static_cast<uint32_t>(index), true});
+    if (target.lastSpot > 0.0) {
+        revalueUnderlying(target, target.lastSpot, target.lastVol, target.lastStep);
+    }
+    return contracts.size() - 1;
+}
+
+void DerivativesBook::setPosition(size_t contract, double quantity) {
+    if (contract >= contracts.size()) {
+        return;
+    }
+    const ContractRef& ref = contracts[contract];
+    Underlying& target = underlyings[ref.underlying];
+    Greeks before = target.totals;
+    if (ref.future) {
+        target.futures.setPosition(ref.index, quantity);
+    } else {
+        double value = target.options.getTotals().value;
+        target.options.setPosition(ref.index, quantity);
+        cashFlow -= target.options.getTotals().value - value;
+    }
+    target.totals = target.options.getTotals();
+    target.totals += target.futures.getTotals();
+    totals += target.totals;
+    totals -= before;
+}
+
+bool DerivativesBook::isSettled(size_t contract) const {
+    if (contract >= contracts.size()) {
+        return false;
+    }
+    const ContractRef& ref = contracts[contract];
+    const Underlying& target = underlyings[ref.underlying];
+    return ref.future ? target.futures.isSettled(ref.index) : target.options.isSettled(ref.index);
+}
+
+double DerivativesBook::getPosition(size_t contract) const {
+    if (contract >= contracts.size()) {
+        return 0.0;
+    }
+    const ContractRef& ref = contracts[contract];
+    const Underlying& target = underlyings[ref.underlying];
+    return ref.future ? target.futures.getPosition(ref.index) : target.options.getPosition(ref.index);
+}
+
+void DerivativesBook::revalue(const Market& market) {
+    long step = market.getCurrentStep();
+    for (Underlying& underlying : underlyings) {
+        if (!market.hasSymbol(underlying.symbol)) {
+            continue;
+        }
+        double spot = market.getCurrentPrice(underlying.symbol);
+        double vol = market.getVolatility(underlying.symbol);
+        if (spot == underlying.lastSpot && vol == underlying.lastVol && step == underlying.lastStep) {
+            continue;
+        }
+        revalueUnderlying(underlying, spot, vol, step);
+    }
+}
+
+double DerivativesBook::takeCashFlow() {
+    double flow = cashFlow;
+    cashFlow = 0.0;
+    return flow;
+}
+
+void DerivativesBook::setRiskFreeRate(double rate) {
+    riskFreeRate = rate;
+    for (Underlying& underlying : underlyings) {
+        if (underlying.lastSpot > 0.0) {
+            revalueUnderlying(underlying, underlying.lastSpot, underlying.lastVol, underlying.lastStep);
+        }
+    }
+}
+
+Greeks DerivativesBook::getContractGreeks(size_t contract) const {
+    if (contract >= contracts.size()) {
+        return Greeks();
+    }
+    const ContractRef& ref = contracts[contract];
+    const Underlying& target = underlyings[ref.underlying];
+    return ref.future ? target.futures.getGreeks(ref.index) : target.options.getGreeks(ref.index);
+}
+
+Greeks DerivativesBook::getUnderlyingTotals(const std::string& symbol) const {
+    auto it = underlyingIndex.find(symbol);
+    return it != underlyingIndex.end() ? underlyings[it->second].totals : Greeks();
+}
+
+const OptionChain* DerivativesBook::getOptionChain(const std::string& symbol) const {
+    auto it = underlyingIndex.find(symbol);
+    return it != underlyingIndex.end() ? &underlyings[it->second].options : nullptr;
+}
+
+DerivativesBook::Underlying& DerivativesBook::underlyingFor(const std::string& symbol) {
+    auto it = underlyingIndex.find(symbol);
+    if (it != underlyingIndex.end()) {
+        return underlyings[it->second];
+    }
+    underlyingIndex[symbol] = underlyings.size();
+    underlyings.emplace_back();
+    underlyings.back().symbol = symbol;
+    return underlyings.back();
+}
+
+void DerivativesBook::revalueUnderlying(Underlying& underlying, double spot, double vol, long step) {
+    Greeks before = underlying.totals;
+    cashFlow += underlying.options.revalue(spot, vol, riskFreeRate, step);
+    cashFlow += underlying.futures.revalue(spot, riskFreeRate, step);
+    underlying.totals = underlying.options.getTotals();
+    underlying.totals += underlying.futures.getTotals();
+    totals += underlying.totals;
+    totals -= before;
+    underlying.lastSpot = spot;
+    underlying.lastVol = vol;
+    underlying.lastStep = step;
+}
@@ -0,0 +1,336 @@
+#include "Exchange.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+
+ExchangeAgent::ExchangeAgent(const std::string &name, double initialCash)
+    : name(name), agentId(0), portfolio(initialCash)
+{
+    // Agents can trade millions of times; keep accounting, not the order log
+    portfolio.setKeepOrderHistory(false);
+}
+
+Exchange::Exchange(Market &market, unsigned int seed)
+    : market(market), randomGenerator(seed), nextOrderId(1), currentStep(0),
+      messageCount(0), rejectedCount(0), tradeCount(0), failedSettlements(0),
+      tradedVolume(0.0), elapsedSeconds(0.0) {}
+
+size_t Exchange::listSymbol(const std::string &symbol, double referencePrice, double tickSize,
+                            double lotSize, const std::string &currency)
+{
+    auto existing = symbolIds.find(symbol);
+    if (existing != symbolIds.end())
+    {
+        return existing->second;
+    }
+
+    if (!market.hasSymbol(symbol))
+    {
+        market.addSymbol(symbol, referencePrice);
+    }
+
+    Listing listing;
+    listing.symbol = symbol;
+    listing.instrument = Instrument(symbol, tickSize, lotSize, currency);
+    listing.referencePrice = listing.instrument.toTicks(referencePrice);
+    listing.stepVolume = 0.0;
+
+    size_t symbolId = listings.size();
+    listings.push_back(std::move(listing));
+    symbolIds[symbol] = symbolId;
+
+    for (size_t i = 0; i < agents.size(); ++i)
+    {
+        agents[i]->portfolio.registerInstrument(listings[symbolId].instrument);
+        accounts[i].reservedSellLots.push_back(0);
+    }
+    return symbolId;
+}
+
+ExchangeAgent &Exchange::addAgent(std::unique_ptr<ExchangeAgent> agent)
+{
+    agent->agentId = static_cast<uint32_t>(agents.size());
+    for (const auto &listing : listings)
+    {
+        agent->portfolio.registerInstrument(listing.instrument);
+    }
+
+    Account account;
+    account.reservedSellLots.assign(listings.size(), 0);
+    accounts.push_back(std::move(account));
+    agentOrder.push_back(agents.size());
+    agents.push_back(std::move(agent));
+    return *agents.back();
+}
+
+uint64_t Exchange::submitOrder(ExchangeAgent &agent, size_t symbolId, OrderType side, Lots lots, Ticks limitPrice,
+                               TimeInForce timeInForce)
+{
+    ++messageCount;
+
+    // Only GTC and IOC are supported by the book
+    bool known = agent.agentId < agents.size() && agents[agent.agentId].get() == &agent;
+    bool supported = timeInForce == TimeInForce::GTC || timeInForce == TimeInForce::IOC;
+    if (!known || !supported || symbolId >= listings.size() || lots <= 0 || limitPrice <= 0)
+    {
+        ++rejectedCount;
+        return 0;
+    }
+
+    Listing &listing = listings[symbolId];
+    const Instrument &instrument = listing.instrument;
+    Account &account = accounts[agent.agentId];
+
+    Money reserve = 0;
+    if (side == OrderType::BUY)
+    {
+        // The order may fill as either side of a trade
+        double quantity = instrument.fromLots(lots);
+        double price = instrument.fromTicks(limitPrice);
+        double fee = std::max(feeModel.computeFee(quantity, price, LiquidityFlag::TAKER),
+                              feeModel.computeFee(quantity, price, LiquidityFlag::MAKER));
+        reserve = instrument.notional(limitPrice, lots) + toMoney(std::max(0.0, fee));
+
+        Money &reserved = account.reservedCash[instrument.currency];
+        if (toMoney(agent.portfolio.getCashBalance(instrument.currency)) - reserved < reserve)
+        {
+            ++rejectedCount;
+            return 0;
+        }
+        reserved += reserve;
+    }
+    else
+    {
+        if (!agent.portfolio.isShortSellingEnabled())
+        {
+            Lots held = instrument.toLots(agent.portfolio.getPositionQuantity(listing.symbol));
+            if (held - account.reservedSellLots[symbolId] < lots)
+            {
+                ++rejectedCount;
+                return 0;
+            }
+        }
+        account.reservedSellLots[symbolId] += lots;
+    }
+
+    uint64_t orderId = nextOrderId++;
+    openOrders.emplace(orderId, OpenOrder{agent.agentId, symbolId, side, lots, reserve});
+
+    tradeScratch.clear();
+    listing.book.submit({orderId, agent.agentId, side, limitPrice, lots}, timeInForce != TimeInForce::IOC, tradeScratch);
+    for (const Trade &trade : tradeScratch)
+    {
+        settle(listing, symbolId, trade);
+    }
+
+    if (timeInForce == TimeInForce::IOC)
+    {
+        auto it = openOrders.find(orderId);
+        if (it != openOrders.end())
+        {
+            releaseOrder(it);
+        }
+    }
+    return orderId;
+}
+
+bool Exchange::cancelOrder(ExchangeAgent &agent, uint64_t orderId)
+{
+    ++messageCount;
+
+    auto it = openOrders.find(orderId);
+    if (it == openOrders.end() || it->second.agentId != agent.agentId)
+    {
+        return false;
+    }
+
+    listings[it->second.symbolId].book.cancel(orderId);
+    releaseOrder(it);
+    return true;
+}
+
+void Exchange::settle(Listing &listing, size_t symbolId, const Trade &trade)
+{
+    // The book has matched the orders either way, so their reservations are consumed
+    consumeReservation(listing, symbolId, trade.buyOrderId, trade.buyAgentId, OrderType::BUY, trade.lots);
+    consumeReservation(listing, symbolId, trade.sellOrderId, trade.sellAgentId, OrderType::SELL, trade.lots);
+
+    const Instrument &instrument = listing.instrument;
+    double quantity = instrument.fromLots(trade.lots);
+    double price = instrument.fromTicks(trade.price);
+    LiquidityFlag buyLiquidity = (trade.aggressor == OrderType::BUY) ? LiquidityFlag::TAKER : LiquidityFlag::MAKER;
+    LiquidityFlag sellLiquidity = (trade.aggressor == OrderType::SELL) ? LiquidityFlag::TAKER : LiquidityFlag::MAKER;
+    double buyFee = feeModel.computeFee(quantity, price, buyLiquidity);
+    double sellFee = feeModel.computeFee(quantity, price, sellLiquidity);
+    ExchangeAgent &buyer = *agents[trade.buyAgentId];
+    ExchangeAgent &seller = *agents[trade.sellAgentId];
+    Order buy(listing.symbol, OrderType::BUY, quantity, price);
+    Order sell(listing.symbol, OrderType::SELL, quantity, price);
+
+    // Both legs settle or neither does, so cash and positions stay conserved
+    // across agents. A self-trade nets to its two fees once the buy has settled.
+    bool affordable = (trade.buyAgentId == trade.sellAgentId)
+        ? buyer.portfolio.canAffordOrder(buy, buyFee + sellFee, nullptr, price)
+        : buyer.portfolio.canAffordOrder(buy, buyFee, nullptr, price) &&
+          seller.portfolio.canAffordOrder(sell, sellFee, nullptr, price);
+    if (!affordable || !buyer.portfolio.executeOrder(buy, price, buyFee))
+    {
+        ++failedSettlements;
+        return;
+    }
+    if (!seller.portfolio.executeOrder(sell, price, sellFee))
+    {
+        // Checked above; only reachable if the portfolios disagree with it
+        ++failedSettlements;
+    }
+
+    buyer.onFill({symbolId, trade.buyOrderId, OrderType::BUY, trade.price, trade.lots, buyLiquidity});
+    seller.onFill({symbolId, trade.sellOrderId, OrderType::SELL, trade.price, trade.lots, sellLiquidity});
+
+    feeModel.recordVolume(quantity);
+    listing.stepVolume += quantity;
+    tradedVolume += quantity;
+    ++tradeCount;
+}
+
+void Exchange::consumeReservation(const Listing &listing, size_t symbolId, uint64_t orderId, uint32_t agentId,
+                                  OrderType side, Lots lots)
+{
+    // Release the part of the reservation this fill consumes
+    auto it = openOrders.find(orderId);
+    if (it == openOrders.end())
+    {
+        return;
+    }
+
+    Account &account = accounts[agentId];
+    OpenOrder &open = it->second;
+    if (side == OrderType::BUY)
+    {
+        Money release = (lots == open.lots)
+            ? open.reservedCash
+            : static_cast<Money>(static_cast<long double>(open.reservedCash) * lots / open.lots);
+        open.reservedCash -= release;
+        account.reservedCash[listing.instrument.currency] -= release;
+    }
+    else
+    {
+        account.reservedSellLots[symbolId] -= lots;
+    }
+
+    open.lots -= lots;
+    if (open.lots == 0)
+    {
+        openOrders.erase(it);
+    }
+}
+
+void Exchange::releaseOrder(std::unordered_map<uint64_t, OpenOrder>::iterator it)
+{
+    const OpenOrder &open = it->second;
+    Account &account = accounts[open.agentId];
+    if (open.side == OrderType::BUY)
+    {
+        account.reservedCash[listings[open.symbolId].instrument.currency] -= open.reservedCash;
+    }
+    else
+    {
+        account.reservedSellLots[open.symbolId] -= open.lots;
+    }
+    openOrders.erase(it);
+}
+
+void Exchange::step()
+{
+    std::shuffle(agentOrder.begin(), agentOrder.end(), randomGenerator);
+    for (size_t index : agentOrder)
+    {
+        agents[index]->onStep(*this, randomGenerator);
+    }
+
+    // Publish the step's last trade so Market analytics follow the exchange
+    for (auto &listing : listings)
+    {
+        if (listing.stepVolume > 0.0)
+        {
+            double price = listing.instrument.fromTicks(listing.book.getLastTradePrice());
+            market.recordTrade(listing.symbol, price, listing.stepVolume);
+            listing.stepVolume = 0.0;
+        }
+    }
+
+    for (auto &agent : agents)
+    {
+        for (const auto &listing : listings)
+        {
+            agent->portfolio.updatePositionValue(listing.symbol, market.getCurrentPrice(listing.symbol));
+        }
+        agent->portfolio.recordEquitySnapshot();
+    }
+    ++currentStep;
+}
+
+void Exchange::run(int steps)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i)
+    {
+        step();
+    }
+    elapsedSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t Exchange::getSymbolId(const std::string &symbol) const
+{
+    auto it = symbolIds.find(symbol);
+    return (it != symbolIds.end()) ? it->second : Market::npos;
+}
+
+Ticks Exchange::getReferencePrice(size_t symbolId) const
+{
+    const Listing &listing = listings[symbolId];
+    Ticks bid = listing.book.getBestBid();
+    Ticks ask = listing.book.getBestAsk();
+    if (bid > 0 && ask > 0)
+    {
+        return (bid + ask) / 2;
+    }
+    Ticks last = listing.book.getLastTradePrice();
+    return (last > 0) ? last : listing.referencePrice;
+}
+
+void Exchange::printSummary() const
+{
+    std::cout << "\n=== Exchange Summary ===" << std::endl;
+    std::cout << "Steps: " << currentStep << ", Agents: " << agents.size() << std::endl;
+    std::cout << "Messages: " << messageCount << " (" << rejectedCount << " rejected)" << std::endl;
+    std::cout << "Trades: " << tradeCount << std::endl;
+    if (failedSettlements > 0)
+    {
+        std::cout << "Failed Settlements: " << failedSettlements << std::endl;
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Traded Volume: " << tradedVolume << std::endl;
+    std::cout << "Throughput: " << getMessagesPerSecond() << " messages/sec" << std::endl;
+
+    for (const auto &listing : listings)
+    {
+        const Instrument &instrument = listing.instrument;
+        std::cout << listing.symbol << ": last $" << instrument.fromTicks(listing.book.getLastTradePrice())
+                  << ", bid $" << instrument.fromTicks(listing.book.getBestBid())
+                  << ", ask $" << instrument.fromTicks(listing.book.getBestAsk())
+                  << ", resting orders " << listing.book.getLiveOrderCount() << std::endl;
+    }
+
+    std::cout << "\nAgent                 Total Value          PnL" << std::endl;
+    for (const auto &agent : agents)
+    {
+        const Portfolio &portfolio = agent->portfolio;
+        std::cout << std::left << std::setw(20) << agent->name << std::right
+                  << std::setw(14) << portfolio.getTotalValue()
+                  << std::setw(13) << portfolio.getTotalValue() - portfolio.getInitialCash() << std::endl;
+    }
+    std::cout << "========================\n"
+              << std::endl;
+}
@@ -0,0 +1,139 @@
+#include "ExchangeAgents.h"
+#include <algorithm>
+
+NoiseTrader::NoiseTrader(const std::string &name, double initialCash, double arrivalProbability,
+                         double marketableProbability, Lots maxLots, Ticks maxOffset, size_t maxOpenOrders)
+    : ExchangeAgent(name, initialCash), arrivalProbability(arrivalProbability),
+      marketableProbability(marketableProbability), maxLots(std::max<Lots>(1, maxLots)),
+      maxOffset(std::max<Ticks>(1, maxOffset)), maxOpenOrders(maxOpenOrders)
+{
+    // Noise traders may sell what they do not hold
+    getPortfolio().setShortSellingEnabled(true);
+}
+
+void NoiseTrader::onStep(Exchange &exchange, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::uniform_int_distribution<Lots> lotsDist(1, maxLots);
+    std::uniform_int_distribution<Ticks> offsetDist(1, maxOffset);
+
+    for (size_t symbolId = 0; symbolId < exchange.getSymbolCount(); ++symbolId)
+    {
+        if (uniform(rng) >= arrivalProbability)
+        {
+            continue;
+        }
+
+        OrderType side = (uniform(rng) < 0.5) ? OrderType::BUY : OrderType::SELL;
+        bool isBuy = side == OrderType::BUY;
+        Ticks reference = exchange.getReferencePrice(symbolId);
+        Ticks offset = offsetDist(rng);
+
+        if (uniform(rng) < marketableProbability)
+        {
+            Ticks limit = isBuy ? reference + offset : reference - offset;
+            exchange.submitOrder(*this, symbolId, side, lotsDist(rng), std::max<Ticks>(1, limit), TimeInForce::IOC);
+            continue;
+        }
+
+        Ticks limit = isBuy ? reference - offset : reference + offset;
+        uint64_t orderId = exchange.submitOrder(*this, symbolId, side, lotsDist(rng), std::max<Ticks>(1, limit));
+        if (orderId != 0)
+        {
+            openOrders.emplace_back(symbolId, orderId);
+        }
+    }
+
+    while (openOrders.size() > maxOpenOrders)
+    {
+        exchange.cancelOrder(*this, openOrders.front().second);
+        openOrders.pop_front();
+    }
+}
+
+MarketMaker::MarketMaker(const std::string &name, double initialCash, Ticks halfSpread, Lots quoteLots,
+                         Lots maxInventory)
+    : ExchangeAgent(name, initialCash), halfSpread(std::max<Ticks>(1, halfSpread)),
+      quoteLots(std::max<Lots>(1, quoteLots)), maxInventory(std::max<Lots>(1, maxInventory))
+{
+    getPortfolio().setShortSellingEnabled(true);
+}
+
+void MarketMaker::onStep(Exchange &exchange, std::mt19937 &)
+{
+    size_t symbolCount = exchange.getSymbolCount();
+    bidIds.resize(symbolCount, 0);
+    askIds.resize(symbolCount, 0);
+
+    for (size_t symbolId = 0; symbolId < symbolCount; ++symbolId)
+    {
+        // Cancel the asks first so the reference is not our own stale quote
+        if (askIds[symbolId] != 0)
+        {
+            exchange.cancelOrder(*this, askIds[symbolId]);
+            askIds[symbolId] = 0;
+        }
+        if (bidIds[symbolId] != 0)
+        {
+            exchange.cancelOrder(*this, bidIds[symbolId]);
+            bidIds[symbolId] = 0;
+        }
+
+        const Instrument &instrument = exchange.getInstrument(symbolId);
+        Lots inventory = instrument.toLots(getPortfolio().getPositionQuantity(exchange.getSymbol(symbolId)));
+        Ticks reference = exchange.getReferencePrice(symbolId);
+
+        // Lean the quotes against inventory: long inventory lowers both prices
+        Ticks skew = -(inventory * halfSpread) / maxInventory;
+        Ticks bid = std::max<Ticks>(1, reference - halfSpread + skew);
+        Ticks ask = std::max<Ticks>(bid + 1, reference + halfSpread + skew);
+
+        if (inventory < maxInventory)
+        {
+            bidIds[symbolId] = exchange.submitOrder(*this, symbolId, OrderType::BUY, quoteLots, bid);
+        }
+        if (inventory > -maxInventory)
+        {
+            askIds[symbolId] = exchange.submitOrder(*this, symbolId, OrderType::SELL, quoteLots, ask);
+        }
+    }
+}
+
+MomentumAgent::MomentumAgent(const std::string &name, double initialCash, size_t window, double threshold,
+                             Lots tradeLots)
+    : ExchangeAgent(name, initialCash), window(std::max<size_t>(2, window)), threshold(threshold),
+      tradeLots(std::max<Lots>(1, tradeLots)), windowRegistered(false) {}
+
+void MomentumAgent::onStep(Exchange &exchange, std::mt19937 &)
+{
+    Market &market = exchange.getMarket();
+    if (!windowRegistered)
+    {
+        market.registerRollingWindow(window);
+        windowRegistered = true;
+    }
+
+    for (size_t symbolId = 0; symbolId < exchange.getSymbolCount(); ++symbolId)
+    {
+        const std::string &symbol = exchange.getSymbol(symbolId);
+        double sma = market.getSMA(symbol, window);
+        if (sma <= 0.0)
+        {
+            continue;
+        }
+
+        const Instrument &instrument = exchange.getInstrument(symbolId);
+        const LimitOrderBook &book = exchange.getBook(symbolId);
+        double price = market.getCurrentPrice(symbol);
+        Lots held = instrument.toLots(getPortfolio().getPositionQuantity(symbol));
+
+        if (price > sma * (1.0 + threshold) && held <= 0 && book.getBestAsk() > 0)
+        {
+            exchange.submitOrder(*this, symbolId, OrderType::BUY, tradeLots, book.getBestAsk(), TimeInForce::IOC);
+        }
+        else if (price < sma * (1.0 - threshold) && held > 0 && book.getBestBid() > 0)
+        {
+            exchange.submitOrder(*this, symbolId, OrderType::SELL, held, book.getBestBid(), TimeInForce::IOC);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include "FeeModel.h"
+#include <algorithm>
+
+FeeModel::FeeModel(double perOrder)
+    : perOrderFee(perOrder), perShareFee(0.0), basisPoints(0.0), makerBasisPoints(0.0),
+      takerBasisPoints(0.0), minimumFee(0.0), currentTier(0), cumulativeVolume(0.0) {}
+
+void FeeModel::setMakerTakerBasisPoints(double makerBps, double takerBps)
+{
+    makerBasisPoints = makerBps;
+    takerBasisPoints = takerBps;
+}
+
+void FeeModel::setVolumeTiers(std::vector<FeeTier> tiers)
+{
+    std::sort(tiers.begin(), tiers.end(),
+              [](const FeeTier &a, const FeeTier &b) { return a.volumeThreshold < b.volumeThreshold; });
+
+    tierThresholds.clear();
+    tierBasisPoints.clear();
+    for (const auto &tier : tiers)
+    {
+        tierThresholds.push_back(tier.volumeThreshold);
+        tierBasisPoints.push_back(tier.basisPoints);
+    }
+    resetVolume();
+}
+
+void FeeModel::recordVolume(double quantity)
+{
+    cumulativeVolume += quantity;
+    while (currentTier + 1 < tierThresholds.size() && cumulativeVolume >= tierThresholds[currentTier + 1])
+    {
+        ++currentTier;
+    }
+}
+
+void FeeModel::resetVolume()
+{
+    cumulativeVolume = 0.0;
+    currentTier = 0;
+}
@@ -0,0 +1,338 @@
+#include "InputJournal.h"
+#include "Market.h"
+#include "TradingEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+const char MAGIC[8] = {'T', 'J', 'N', 'L', '0', '0', '0', '1'};
+
+// Bounds-checked cursor over the journal image
+struct Cursor {
+    const char* data;
+    size_t size;
+    size_t offset;
+
+    template <typename T>
+    bool get(T& value) {
+        if (size - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t length;
+        if (!get(length) || size - offset < length) {
+            return false;
+        }
+        value.assign(data + offset, length);
+        offset += length;
+        return true;
+    }
+};
+
+struct CallContext {
+    std::string activeStrategy;
+    uint32_t quoteDelay;
+};
+
+bool readContext(Cursor& cursor, CallContext& context) {
+    return cursor.getString(context.activeStrategy) && cursor.get(context.quoteDelay);
+}
+
+bool readFile(const std::string& path, std::vector<char>& image) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char chunk[1 << 16];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        image.insert(image.end(), chunk, chunk + read);
+    }
+    bool ok = !std::ferror(file);
+    std::fclose(file);
+    return ok;
+}
+}
+
+InputJournal::InputJournal(const std::string& path, size_t syncInterval, size_t bufferBytes)
+    : file(std::fopen(path.c_str(), "wb")), bufferLimit(bufferBytes), syncInterval(syncInterval),
+      unsyncedRecords(0), recordCount(0) {
+    buffer.reserve(bufferLimit + 256);
+    if (file && std::fwrite(MAGIC, 1, sizeof(MAGIC), file) != sizeof(MAGIC)) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+InputJournal::~InputJournal() {
+    close();
+}
+
+void InputJournal::recordSymbols(const Market& market) {
+    const std::vector<std::string>& symbols = market.getSymbolsByIndex();
+    beginRecord(JournalRecord::SYMBOLS);
+    put(static_cast<uint32_t>(symbols.size()));
+    for (const std::string& symbol : symbols) {
+        putString(symbol);
+        put(market.getCurrentPrice(symbol));
+        put(market.getVolatility(symbol));
+    }
+    endRecord();
+}
+
+void InputJournal::recordTick(long step, const MarketSnapshot& snapshot) {
+    beginRecord(JournalRecord::TICK);
+    put(static_cast<int64_t>(step));
+    put(static_cast<uint32_t>(snapshot.size()));
+    const char* prices = reinterpret_cast<const char*>(snapshot.prices.data());
+    buffer.insert(buffer.end(), prices, prices + snapshot.size() * sizeof(double));
+    endRecord();
+}
+
+void InputJournal::recordSubmit(const std::string& activeStrategy, size_t quoteDelay, const Order& order) {
+    beginRecord(JournalRecord::SUBMIT);
+    putContext(activeStrategy, quoteDelay);
+    put(static_cast<int32_t>(order.getOrderId()));
+    putString(order.getSymbol());
+    put(static_cast<uint8_t>(order.getType()));
+    put(order.getQuantity());
+    put(order.getPrice());
+    put(static_cast<uint8_t>(order.getExecutionType()));
+    put(static_cast<uint8_t>(order.getTimeInForce()));
+    put(order.getStopPrice());
+    put(order.getTrailAmount());
+    put(static_cast<int64_t>(order.getExpiryStep()));
+    putString(order.getTag());
+    endRecord();
+}
+
+void InputJournal::recordMarketOrder(const std::string& activeStrategy, size_t quoteDelay, int orderId,
+                                     const std::string& symbol, OrderType type, double quantity) {
+    beginRecord(JournalRecord::MARKET_ORDER);
+    putContext(activeStrategy, quoteDelay);
+    put(static_cast<int32_t>(orderId));
+    putString(symbol);
+    put(static_cast<uint8_t>(type));
+    put(quantity);
+    endRecord();
+}
+
+void InputJournal::recordCancel(const std::string& activeStrategy, size_t quoteDelay, int orderId) {
+    beginRecord(JournalRecord::CANCEL);
+    putContext(activeStrategy, quoteDelay);
+    put(static_cast<int32_t>(orderId));
+    endRecord();
+}
+
+void InputJournal::recordProcess() {
+    beginRecord(JournalRecord::PROCESS);
+    endRecord();
+}
+
+void InputJournal::flush() {
+    if (!file) {
+        return;
+    }
+    writeBuffer();
+    if (std::fflush(file) != 0 || ::fsync(::fileno(file)) != 0) {
+        // A journal that cannot be made durable is useless; stop recording
+        std::fclose(file);
+        file = nullptr;
+        return;
+    }
+    unsyncedRecords = 0;
+}
+
+void InputJournal::close() {
+    if (!file) {
+        return;
+    }
+    flush();
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void InputJournal::putString(const std::string& value) {
+    put(static_cast<uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void InputJournal::beginRecord(JournalRecord type) {
+    buffer.push_back(static_cast<char>(type));
+}
+
+void InputJournal::putContext(const std::string& activeStrategy, size_t quoteDelay) {
+    putString(activeStrategy);
+    put(static_cast<uint32_t>(quoteDelay));
+}
+
+void InputJournal::endRecord() {
+    if (!file) {
+        buffer.clear();
+        return;
+    }
+    ++recordCount;
+    ++unsyncedRecords;
+    if (unsyncedRecords >= syncInterval) {
+        flush();
+    } else if (buffer.size() >= bufferLimit) {
+        writeBuffer();
+    }
+}
+
+void InputJournal::writeBuffer() {
+    if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    buffer.clear();
+}
+
+ReplayResult JournalReplayer::replay(const std::string& path, Market& market, TradingEngine& engine) {
+    ReplayResult result;
+    std::vector<char> image;
+    if (!readFile(path, image)) {
+        result.error = "cannot read " + path;
+        return result;
+    }
+    if (image.size() < sizeof(MAGIC) || std::memcmp(image.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        result.error = "not a journal: " + path;
+        return result;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Cursor cursor{image.data(), image.size(), sizeof(MAGIC)};
+    // Replayed orders rewind the id counter to their recorded ids; it is put
+    // back afterwards so later orders never reuse an id handed out before
+    int savedOrderId = Order::getNextOrderId();
+    CallContext context;
+    std::string symbol;
+    std::string tag;
+    std::vector<double> prices;
+
+    // Calls run with the strategy tag and quote delay they were recorded under
+    auto enter = [&]() {
+        engine.setActiveStrategy(context.activeStrategy);
+        market.setQuoteDelay(context.quoteDelay);
+        ++result.calls;
+    };
+
+    while (cursor.offset < cursor.size) {
+        size_t recordStart = cursor.offset;
+        uint8_t type = 0;
+        cursor.get(type);
+        bool complete = true;
+
+        switch (static_cast<JournalRecord>(type)) {
+            case JournalRecord::SYMBOLS: {
+                uint32_t count = 0;
+                complete = cursor.get(count);
+                for (uint32_t i = 0; complete && i < count; ++i) {
+                    double price;
+                    double vol;
+                    complete = cursor.getString(symbol) && cursor.get(price) && cursor.get(vol);
+                    if (complete && !market.hasSymbol(symbol)) {
+                        market.addSymbol(symbol, price, vol);
+                    }
+                }
+                break;
+            }
+            case JournalRecord::TICK: {
+                int64_t step;
+                uint32_t count = 0;
+                complete = cursor.get(step) && cursor.get(count) && cursor.size - cursor.offset >= count * sizeof(double);
+                if (complete) {
+                    prices.resize(count);
+                    std::memcpy(prices.data(), cursor.data + cursor.offset, count * sizeof(double));
+                    cursor.offset += count * sizeof(double);
+                    market.setQuoteDelay(0);
+                    market.setPrices(prices);
+                    engine.markToMarket();
+                    ++result.ticks;
+                }
+                break;
+            }
+            case JournalRecord::SUBMIT: {
+                int32_t orderId;
+                uint8_t side;
+                uint8_t executionType;
+                uint8_t timeInForce;
+                double quantity;
+                double price;
+                double stopPrice;
+                double trailAmount;
+                int64_t expiryStep;
+                complete = readContext(cursor, context) && cursor.get(orderId) && cursor.getString(symbol) &&
+                           cursor.get(side) && cursor.get(quantity) && cursor.get(price) &&
+                           cursor.get(executionType) && cursor.get(timeInForce) && cursor.get(stopPrice) &&
+                           cursor.get(trailAmount) && cursor.get(expiryStep) && cursor.getString(tag);
+                if (complete) {
+                    Order::setNextOrderId(orderId);
+                    Order order(symbol, static_cast<OrderType>(side), quantity, price);
+                    order.setExecutionType(static_cast<ExecutionType>(executionType));
+                    order.setTimeInForce(static_cast<TimeInForce>(timeInForce), static_cast<long>(expiryStep));
+                    order.setStopPrice(stopPrice);
+                    order.setTrailAmount(trailAmount);
+                    order.setTag(tag);
+                    enter();
+                    engine.submitOrder(order);
+                }
+                break;
+            }
+            case JournalRecord::MARKET_ORDER: {
+                int32_t orderId;
+                uint8_t side;
+                double quantity;
+                complete = readContext(cursor, context) && cursor.get(orderId) && cursor.getString(symbol) &&
+                           cursor.get(side) && cursor.get(quantity);
+                if (complete) {
+                    Order::setNextOrderId(orderId);
+                    enter();
+                    engine.executeMarketOrder(symbol, static_cast<OrderType>(side), quantity);
+                }
+                break;
+            }
+            case JournalRecord::CANCEL: {
+                int32_t orderId;
+                complete = readContext(cursor, context) && cursor.get(orderId);
+                if (complete) {
+                    enter();
+                    engine.cancelOrder(orderId);
+                }
+                break;
+            }
+            case JournalRecord::PROCESS:
+                market.setQuoteDelay(0);
+                engine.processOrders();
+                ++result.calls;
+                break;
+            default:
+                result.error = "unknown record type at offset " + std::to_string(recordStart);
+                market.setQuoteDelay(0);
+                Order::setNextOrderId(std::max(savedOrderId, Order::getNextOrderId()));
+                return result;
+        }
+
+        if (!complete) {
+            result.truncated = true;
+            break;
+        }
+        ++result.records;
+    }
+
+    market.setQuoteDelay(0);
+    engine.setActiveStrategy("");
+    Order::setNextOrderId(std::max(savedOrderId, Order::getNextOrderId()));
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ok = true;
+    return result;
+}
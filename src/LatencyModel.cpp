@@ -0,0 +1,51 @@
+#include "LatencyModel.h"
+
+LatencyQueue::LatencyQueue(size_t wheelSlots) : wheel(wheelSlots)
+{
+    slots.reserve(INITIAL_CAPACITY);
+    freeSlots.reserve(INITIAL_CAPACITY);
+    arrivedSlots.reserve(INITIAL_CAPACITY);
+}
+
+void LatencyQueue::send(Kind kind, int orderId, const Order *order, long sentStep, long arrivalStep)
+{
+    int slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<int>(slots.size());
+        slots.push_back({kind, orderId, std::nullopt, sentStep, arrivalStep});
+    }
+
+    Message &message = slots[slot];
+    message.kind = kind;
+    message.orderId = orderId;
+    message.sentStep = sentStep;
+    message.arrivalStep = arrivalStep;
+    if (order)
+    {
+        message.order = *order;
+    }
+    else
+    {
+        message.order.reset();
+    }
+    wheel.schedule(slot, arrivalStep);
+}
+
+void LatencyQueue::collectArrived(long step, std::vector<Message> &arrived)
+{
+    arrived.clear();
+    arrivedSlots.clear();
+    wheel.advance(step, arrivedSlots);
+
+    for (int slot : arrivedSlots)
+    {
+        arrived.push_back(std::move(slots[slot]));
+        freeSlots.push_back(slot);
+    }
+}
@@ -0,0 +1,127 @@
+#include "LimitOrderBook.h"
+#include <algorithm>
+
+Lots LimitOrderBook::submit(const BookOrder &order, bool rest, std::vector<Trade> &trades)
+{
+    Lots remaining = (order.side == OrderType::BUY) ? match(asks, order, trades) : match(bids, order, trades);
+
+    if (remaining > 0 && rest)
+    {
+        Level &level = (order.side == OrderType::BUY) ? bids[order.price] : asks[order.price];
+        level.queue.push_back({order.orderId, order.agentId});
+        level.volume += remaining;
+        live[order.orderId] = {order.side, order.price, remaining};
+    }
+    return remaining;
+}
+
+template <typename Levels>
+Lots LimitOrderBook::match(Levels &levels, const BookOrder &order, std::vector<Trade> &trades)
+{
+    Lots remaining = order.lots;
+    bool isBuy = order.side == OrderType::BUY;
+
+    while (remaining > 0 && !levels.empty())
+    {
+        auto levelIt = levels.begin();
+        Ticks price = levelIt->first;
+        if (isBuy ? price > order.price : price < order.price)
+        {
+            break;
+        }
+
+        Level &level = levelIt->second;
+        while (remaining > 0 && !level.queue.empty())
+        {
+            const QueueEntry &head = level.queue.front();
+            auto it = live.find(head.orderId);
+            if (it == live.end())
+            {
+                // Cancelled earlier; drop the stale slot
+                level.queue.pop_front();
+                continue;
+            }
+
+            Lots fill = std::min(remaining, it->second.lots);
+            Trade trade;
+            trade.buyOrderId = isBuy ? order.orderId : head.orderId;
+            trade.sellOrderId = isBuy ? head.orderId : order.orderId;
+            trade.buyAgentId = isBuy ? order.agentId : head.agentId;
+            trade.sellAgentId = isBuy ? head.agentId : order.agentId;
+            trade.price = price;
+            trade.lots = fill;
+            trade.aggressor = order.side;
+            trades.push_back(trade);
+
+            remaining -= fill;
+            level.volume -= fill;
+            it->second.lots -= fill;
+            lastTradePrice = price;
+            if (it->second.lots == 0)
+            {
+                live.erase(it);
+                level.queue.pop_front();
+            }
+        }
+
+        if (level.volume == 0)
+        {
+            levels.erase(levelIt);
+        }
+    }
+    return remaining;
+}
+
+Lots LimitOrderBook::cancel(uint64_t orderId)
+{
+    auto it = live.find(orderId);
+    if (it == live.end())
+    {
+        return 0;
+    }
+
+    LiveOrder order = it->second;
+    live.erase(it);
+    if (order.side == OrderType::BUY)
+    {
+        eraseLive(bids, orderId, order);
+    }
+    else
+    {
+        eraseLive(asks, orderId, order);
+    }
+    return order.lots;
+}
+
+template <typename Levels>
+void LimitOrderBook::eraseLive(Levels &levels, uint64_t orderId, const LiveOrder &order)
+{
+    auto levelIt = levels.find(order.price);
+    if (levelIt == levels.end())
+    {
+        return;
+    }
+
+    Level &level = levelIt->second;
+    level.volume -= order.lots;
+    if (level.volume == 0)
+    {
+        levels.erase(levelIt);
+    }
+    else if (!level.queue.empty() && level.queue.back().orderId == orderId)
+    {
+        // Cheap case for quote replacement: the newest order is cancelled first
+        level.queue.pop_back();
+    }
+}
+
+Lots LimitOrderBook::getDepth(OrderType side, Ticks price) const
+{
+    if (side == OrderType::BUY)
+    {
+        auto it = bids.find(price);
+        return (it != bids.end()) ? it->second.volume : 0;
+    }
+    auto it = asks.find(price);
+    return (it != asks.end()) ? it->second.volume : 0;
+}
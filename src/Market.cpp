@@ -5,19 +5,59 @@
 #include <cmath>
 
 Market::Market() : randomGenerator(std::chrono::system_clock::now().time_since_epoch().count()),
-                   normalDist(0.0, 1.0) {}
+                   normalDist(0.0, 1.0), quoteDelay(0) {}
 
 void Market::addSymbol(const std::string& symbol, double initialPrice, double vol) {
+    if (symbolIndex.find(symbol) == symbolIndex.end()) {
+        symbolIndex[symbol] = symbols.size();
+        symbols.push_back(symbol);
+        sortedSymbols.insert(std::lower_bound(sortedSymbols.begin(), sortedSymbols.end(), symbol), symbol);
+        snapshot.prices.push_back(initialPrice);
+        snapshot.returns.push_back(0.0);
+        snapshot.volatilities.push_back(vol);
+        snapshot.sectors.push_back(-1);
+        for (auto& pair : rollingStats) {
+            pair.second.addSymbol();
+        }
+        for (auto& pair : barSeries) {
+            pair.second.addSymbol();
+        }
+        priceUpdates.push_back(0);
+    }
+    size_t index = symbolIndex[symbol];
+    snapshot.prices[index] = initialPrice;
+    snapshot.returns[index] = 0.0;
+    snapshot.volatilities[index] = vol;
+    
     currentPrices[symbol] = initialPrice;
     volatility[symbol] = vol;
-    priceHistory[symbol] = std::vector<PriceData>();
+    // Full capacity up front so recording never reallocates
+    std::vector<PriceData>& history = priceHistory[symbol];
+    history.clear();
+    history.reserve(HISTORY_LENGTH + 1);
     recordPrice(symbol, initialPrice);
 }
 
 void Market::updatePrices() {
-    for (auto& pair : currentPrices) {
-        simulatePriceMovement(pair.first);
+    if (priceModel.isActive() && priceModel.getSymbolCount() == symbols.size()) {
+        priceModel.generate(randomGenerator, 1.0 / 252.0, shockBuffer, jumpBuffer);
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            applyPriceShock(symbols[i], shockBuffer[i], jumpBuffer[i]);
+        }
+    } else {
+        for (auto& pair : currentPrices) {
+            simulatePriceMovement(pair.first);
+        }
+    }
+    ++snapshot.step;
+}
+
+void Market::setPrices(const std::vector<double>& prices) {
+    for (size_t i = 0; i < symbols.size() && i < prices.size(); ++i) {
+        currentPrices[symbols[i]] = prices[i];
+        recordPrice(symbols[i], prices[i]);
     }
+    ++snapshot.step;
 }
 
 void Market::simulatePriceMovement(const std::string& symbol) {
@@ -25,23 +65,86 @@ void Market::simulatePriceMovement(const std::string& symbol) {
         return;
     }
     
+    applyPriceShock(symbol, normalDist(randomGenerator), 0.0);
+}
+
+void Market::recordTrade(const std::string& symbol, double price, double volume) {
+    if (!hasSymbol(symbol) || price <= 0.0) {
+        return;
+    }
+    
+    currentPrices[symbol] = price;
+    recordPrice(symbol, price, volume);
+}
+
+bool Market::setPriceModel(const CorrelatedPriceModel& model) {
+    if (model.getSymbolCount() != symbols.size()) {
+        return false;
+    }
+    priceModel = model;
+    return true;
+}
+
+bool Market::setCovarianceMatrix(const std::vector<double>& covariance) {
+    size_t n = symbols.size();
+    if (covariance.size() != n * n) {
+        return false;
+    }
+    
+    // Split into per-symbol volatilities and a correlation matrix
+    std::vector<double> vols(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (covariance[i * n + i] <= 0.0) {
+            return false;
+        }
+        vols[i] = std::sqrt(covariance[i * n + i]);
+    }
+    std::vector<double> correlation(n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            correlation[i * n + j] = covariance[i * n + j] / (vols[i] * vols[j]);
+        }
+    }
+    
+    CorrelatedPriceModel model(n);
+    if (!model.setCorrelationMatrix(correlation)) {
+        return false;
+    }
+    priceModel = model;
+    for (size_t i = 0; i < n; ++i) {
+        setVolatility(symbols[i], vols[i]);
+    }
+    return true;
+}
+
+void Market::applyPriceShock(const std::string& symbol, double shock, double logJump) {
     double currentPrice = currentPrices[symbol];
     double vol = volatility[symbol];
     
     // Simple geometric Brownian motion simulation
     double dt = 1.0 / 252.0; // Daily time step (assuming 252 trading days per year)
     double drift = 0.05; // 5% annual expected return
-    double randomShock = normalDist(randomGenerator);
     
     // Price change using GBM: dS = S * (mu * dt + sigma * sqrt(dt) * Z)
-    double priceChange = currentPrice * (drift * dt + vol * std::sqrt(dt) * randomShock);
-    double newPrice = std::max(0.01, currentPrice + priceChange); // Ensure price doesn't go negative
+    double priceChange = currentPrice * (drift * dt + vol * std::sqrt(dt) * shock);
+    double newPrice = currentPrice + priceChange;
+    if (logJump != 0.0) {
+        newPrice *= std::exp(logJump);
+    }
+    newPrice = std::max(0.01, newPrice); // Ensure price doesn't go negative
     
     currentPrices[symbol] = newPrice;
     recordPrice(symbol, newPrice);
 }
 
 double Market::getCurrentPrice(const std::string& symbol) const {
+    if (quoteDelay > 0) {
+        auto historyIt = priceHistory.find(symbol);
+        if (historyIt != priceHistory.end() && !historyIt->second.empty()) {
+            const auto& history = historyIt->second;
+            return history[history.size() - 1 - std::min(quoteDelay, history.size() - 1)].price;
+        }
+    }
     auto it = currentPrices.find(symbol);
     return (it != currentPrices.end()) ? it->second : 0.0;
 }
@@ -63,8 +166,12 @@ double Market::getDailyReturn(const std::string& symbol) const {
     }
     
     const auto& history = it->second;
-    double currentPrice = history.back().price;
-    double previousPrice = history[history.size() - 2].price;
+    size_t last = history.size() - 1 - std::min(quoteDelay, history.size() - 1);
+    if (last == 0) {
+        return 0.0;
+    }
+    double currentPrice = history[last].price;
+    double previousPrice = history[last - 1].price;
     
     return (currentPrice - previousPrice) / previousPrice * 100.0;
 }
@@ -77,15 +184,115 @@ double Market::getVolatility(const std::string& symbol) const {
 void Market::setVolatility(const std::string& symbol, double vol) {
     if (hasSymbol(symbol)) {
         volatility[symbol] = vol;
+        snapshot.volatilities[getSymbolIndex(symbol)] = vol;
     }
 }
 
-std::vector<std::string> Market::getAvailableSymbols() const {
-    std::vector<std::string> symbols;
-    for (const auto& pair : currentPrices) {
-        symbols.push_back(pair.first);
+void Market::setSector(const std::string& symbol, int sector) {
+    size_t index = getSymbolIndex(symbol);
+    if (index != npos) {
+        snapshot.sectors[index] = sector;
+    }
+}
+
+const RollingStatistics& Market::registerRollingWindow(size_t window) {
+    auto it = rollingStats.find(window);
+    if (it != rollingStats.end()) {
+        return it->second;
+    }
+    
+    RollingStatistics& stats = rollingStats.emplace(window, RollingStatistics(window)).first->second;
+    
+    // Seed the new window from the history we already have
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        stats.addSymbol();
+        const auto& history = priceHistory[symbols[i]];
+        size_t start = history.size() > window + 1 ? history.size() - window - 1 : 0;
+        for (size_t k = start; k < history.size(); ++k) {
+            stats.update(i, history[k].price, history[k].volume);
+        }
+    }
+    return stats;
+}
+
+const BarSeries& Market::registerBarResolution(size_t updatesPerBar, size_t capacity) {
+    updatesPerBar = std::max<size_t>(1, updatesPerBar);
+    auto it = barSeries.find(updatesPerBar);
+    if (it != barSeries.end()) {
+        return it->second;
     }
-    return symbols;
+    
+    BarSeries& series = barSeries.emplace(updatesPerBar, BarSeries(updatesPerBar, capacity)).first->second;
+    
+    // Seed from the retained history, numbered as it was recorded so bars
+    // line up with those of other resolutions
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        series.addSymbol();
+        const auto& history = priceHistory[symbols[i]];
+        uint64_t first = priceUpdates[i] - history.size();
+        for (size_t k = 0; k < history.size(); ++k) {
+            series.update(i, first + k, history[k].price, history[k].volume);
+        }
+    }
+    return series;
+}
+
+const BarSeries* Market::getBarSeries(size_t updatesPerBar) const {
+    auto it = barSeries.find(updatesPerBar);
+    return (it != barSeries.end()) ? &it->second : nullptr;
+}
+
+BarView Market::getBars(const std::string& symbol, size_t updatesPerBar) const {
+    const BarSeries* series = getBarSeries(updatesPerBar);
+    size_t index = getSymbolIndex(symbol);
+    return (series && index != npos) ? series->getBars(index) : BarView();
+}
+
+const RollingStatistics* Market::getRollingStatistics(size_t window) const {
+    auto it = rollingStats.find(window);
+    return (it != rollingStats.end()) ? &it->second : nullptr;
+}
+
+double Market::getSMA(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getSMA(index) : 0.0;
+}
+
+double Market::getEMA(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getEMA(index) : 0.0;
+}
+
+double Market::getRollingVariance(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getVariance(index) : 0.0;
+}
+
+double Market::getRealizedVolatility(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getRealizedVolatility(index) : 0.0;
+}
+
+double Market::getRollingMin(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getMin(index) : 0.0;
+}
+
+double Market::getRollingMax(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getMax(index) : 0.0;
+}
+
+double Market::getVWAP(const std::string& symbol, size_t window) const {
+    size_t index;
+    const RollingStatistics* stats = findStatistics(symbol, window, index);
+    return stats ? stats->getVWAP(index) : 0.0;
 }
 
 void Market::printMarketSummary() const {
@@ -105,11 +312,65 @@ void Market::printMarketSummary() const {
     std::cout << "=====================\n" << std::endl;
 }
 
+void Market::setQuoteDelay(size_t steps) {
+    // History only reaches back HISTORY_LENGTH points
+    quoteDelay = std::min(steps, HISTORY_LENGTH - 1);
+}
+
+const MarketSnapshot& Market::delayedView() const {
+    // Assignment reuses the buffers' capacity once they are sized
+    delayedSnapshot = snapshot;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        auto it = priceHistory.find(symbols[i]);
+        if (it == priceHistory.end() || it->second.empty()) {
+            continue;
+        }
+        const auto& history = it->second;
+        size_t last = history.size() - 1 - std::min(quoteDelay, history.size() - 1);
+        double previous = (last > 0) ? history[last - 1].price : 0.0;
+        delayedSnapshot.prices[i] = history[last].price;
+        delayedSnapshot.returns[i] = (previous > 0.0) ? (history[last].price - previous) / previous : 0.0;
+    }
+    delayedSnapshot.step = std::max(0L, snapshot.step - static_cast<long>(quoteDelay));
+    return delayedSnapshot;
+}
+
+size_t Market::getSymbolIndex(const std::string& symbol) const {
+    auto it = symbolIndex.find(symbol);
+    return (it != symbolIndex.end()) ? it->second : npos;
+}
+
+const RollingStatistics* Market::findStatistics(const std::string& symbol, size_t window, size_t& index) const {
+    auto statsIt = rollingStats.find(window);
+    if (statsIt == rollingStats.end()) {
+        return nullptr;
+    }
+    index = getSymbolIndex(symbol);
+    return (index != npos) ? &statsIt->second : nullptr;
+}
+
 void Market::recordPrice(const std::string& symbol, double price, double volume) {
-    priceHistory[symbol].emplace_back(price, volume);
+    std::vector<PriceData>& history = priceHistory[symbol];
+    history.emplace_back(price, volume);
+    
+    size_t index = getSymbolIndex(symbol);
+    double previous = snapshot.prices[index];
+    snapshot.returns[index] = (previous > 0.0) ? (price - previous) / previous : 0.0;
+    snapshot.prices[index] = price;
+    
+    if (!rollingStats.empty()) {
+        for (auto& pair : rollingStats) {
+            pair.second.update(index, price, volume);
+        }
+    }
+    
+    uint64_t sequence = priceUpdates[index]++;
+    for (auto& pair : barSeries) {
+        pair.second.update(index, sequence, price, volume);
+    }
     
-    // Keep only last 1000 price points to prevent memory issues
-    if (priceHistory[symbol].size() > 1000) {
-        priceHistory[symbol].erase(priceHistory[symbol].begin());
+    // Keep only the last HISTORY_LENGTH price points to prevent memory issues
+    if (history.size() > HISTORY_LENGTH) {
+        history.erase(history.begin());
     }
 }
@@ -0,0 +1,37 @@
+#include "MarketPath.h"
+#include "Market.h"
+
+MarketPath MarketPath::fromHistory(const Market& market) {
+    MarketPath path;
+    const std::vector<std::string>& symbols = market.getSymbolsByIndex();
+    if (symbols.empty()) {
+        return path;
+    }
+
+    size_t rows = static_cast<size_t>(-1);
+    for (const std::string& symbol : symbols) {
+        rows = std::min(rows, market.getPriceHistory(symbol).size());
+    }
+    if (rows == 0) {
+        return path;
+    }
+
+    // Align the tails: every symbol contributes its last 'rows' points
+    size_t count = symbols.size();
+    path.symbolCount = count;
+    path.stepCount = rows - 1;
+    path.prices.resize(rows * count);
+    path.returns.assign(rows * count, 0.0);
+    for (size_t i = 0; i < count; ++i) {
+        const std::vector<PriceData>& history = market.getPriceHistory(symbols[i]);
+        size_t offset = history.size() - rows;
+        for (size_t row = 0; row < rows; ++row) {
+            path.prices[row * count + i] = history[offset + row].price;
+            if (row > 0) {
+                double previous = history[offset + row - 1].price;
+                path.returns[row * count + i] = previous > 0.0 ? history[offset + row].price / previous - 1.0 : 0.0;
+            }
+        }
+    }
+    return path;
+}
@@ -0,0 +1,326 @@
+#include "MetricsExporter.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define METRICS_HTTP_SUPPORTED 1
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // a client hanging up must not raise SIGPIPE where supported
+#endif
+#endif
+
+static_assert(std::is_trivially_copyable<EngineMetrics>::value, "EngineMetrics is published word by word");
+
+MetricsPublisher::MetricsPublisher(double rateWindowSeconds)
+    : sequence(0), stepBuckets{}, stepCount(0), stepSeconds(0.0), windowSteps(0), windowOrders(0),
+      stepsPerSecond(0.0), ordersPerSecond(0.0), rateWindow(rateWindowSeconds) {
+    for (auto& word : words) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricsPublisher::observeStepDuration(double seconds) {
+    size_t bucket = 0;
+    while (bucket < EngineMetrics::STEP_BUCKETS && seconds > EngineMetrics::STEP_BUCKET_BOUNDS[bucket]) {
+        ++bucket;
+    }
+    ++stepBuckets[bucket];
+    ++stepCount;
+    stepSeconds += seconds;
+}
+
+void MetricsPublisher::publish(const EngineMetrics& metrics) {
+    // Rates over the last complete window, so a scrape sees a steady value
+    auto now = std::chrono::steady_clock::now();
+    if (sequence.load(std::memory_order_relaxed) == 0) {
+        windowStart = now;
+        windowSteps = metrics.steps;
+        windowOrders = metrics.ordersReceived;
+    }
+    std::chrono::duration<double> elapsed = now - windowStart;
+    if (elapsed >= rateWindow && elapsed.count() > 0.0) {
+        stepsPerSecond = static_cast<double>(metrics.steps - windowSteps) / elapsed.count();
+        ordersPerSecond = static_cast<double>(metrics.ordersReceived - windowOrders) / elapsed.count();
+        windowStart = now;
+        windowSteps = metrics.steps;
+        windowOrders = metrics.ordersReceived;
+    }
+
+    EngineMetrics snapshot = metrics;
+    snapshot.stepsPerSecond = stepsPerSecond;
+    snapshot.ordersPerSecond = ordersPerSecond;
+    std::memcpy(snapshot.stepBuckets, stepBuckets, sizeof(stepBuckets));
+    snapshot.stepCount = stepCount;
+    snapshot.stepSeconds = stepSeconds;
+
+    uint64_t buffer[WORDS] = {};
+    std::memcpy(buffer, &snapshot, sizeof(snapshot));
+
+    // Seqlock write: odd while the words change
+    uint64_t version = sequence.load(std::memory_order_relaxed);
+    sequence.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i) {
+        words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+    sequence.store(version + 2, std::memory_order_release);
+}
+
+bool MetricsPublisher::read(EngineMetrics& out) const {
+    uint64_t buffer[WORDS];
+    while (true) {
+        uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < WORDS; ++i) {
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            std::memcpy(&out, buffer, sizeof(out));
+            return before != 0;
+        }
+    }
+}
+
+namespace {
+const char* eventLabel(size_t event) {
+    switch (static_cast<OrderEvent>(event)) {
+        case OrderEvent::SUBMITTED: return "submitted";
+        case OrderEvent::TRIGGERED: return "triggered";
+        case OrderEvent::CANCELLED: return "cancelled";
+        case OrderEvent::EXPIRED: return "expired";
+        case OrderEvent::REJECTED: return "rejected";
+    }
+    return "unknown";
+}
+
+void appendf(std::string& out, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length > 0) {
+        out.append(line, std::min<size_t>(static_cast<size_t>(length), sizeof(line) - 1));
+    }
+}
+
+void header(std::string& out, const char* name, const char* type, const char* help) {
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void counter(std::string& out, const char* name, const char* help, uint64_t value) {
+    header(out, name, "counter", help);
+    appendf(out, "%s %llu\n", name, static_cast<unsigned long long>(value));
+}
+
+void counter(std::string& out, const char* name, const char* help, double value) {
+    header(out, name, "counter", help);
+    appendf(out, "%s %.17g\n", name, value);
+}
+
+void gauge(std::string& out, const char* name, const char* help, double value) {
+    header(out, name, "gauge", help);
+    appendf(out, "%s %.17g\n", name, value);
+}
+}
+
+std::string MetricsExporter::render(const EngineMetrics& metrics, uint64_t publishCount) {
+    std::string out;
+    out.reserve(4096);
+
+    counter(out, "trading_steps_total", "Engine steps processed.", metrics.steps);
+    counter(out, "trading_orders_received_total", "Order-entry calls, before latency and validation.",
+            metrics.ordersReceived);
+    header(out, "trading_order_events_total", "counter", "Order lifecycle events by type.");
+    for (size_t event = 0; event < EngineMetrics::ORDER_EVENTS; ++event) {
+        appendf(out, "trading_order_events_total{event=\"%s\"} %llu\n", eventLabel(event),
+                static_cast<unsigned long long>(metrics.orderEvents[event]));
+    }
+    counter(out, "trading_fills_total", "Orders executed.", metrics.fills);
+    counter(out, "trading_hot_path_allocations_total", "Heap allocations inside simulation steps.",
+            metrics.hotPathAllocations);
+    counter(out, "trading_fees_total", "Fees charged so far.", metrics.totalFees);
+    counter(out, "trading_metrics_publishes_total", "Snapshots published by the engine.", publishCount);
+
+    gauge(out, "trading_steps_per_second", "Steps per wall-clock second over the last rate window.",
+          metrics.stepsPerSecond);
+    gauge(out, "trading_orders_per_second", "Orders received per wall-clock second over the last rate window.",
+          metrics.ordersPerSecond);
+    gauge(out, "trading_resting_orders", "Working orders resting in the books.",
+          static_cast<double>(metrics.restingOrders));
+    gauge(out, "trading_in_flight_messages", "Orders and cancels delayed by the latency model.",
+          static_cast<double>(metrics.inFlightMessages));
+    gauge(out, "trading_pending_result_chunks", "Result chunks waiting for the writer threads.",
+          static_cast<double>(metrics.pendingResultChunks));
+    gauge(out, "trading_equity", "Portfolio total value.", metrics.equity);
+    gauge(out, "trading_cash", "Portfolio cash.", metrics.cash);
+
+    const char* histogram = "trading_step_duration_seconds";
+    header(out, histogram, "histogram", "Wall time of one runSimulation step.");
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < EngineMetrics::STEP_BUCKETS; ++bucket) {
+        cumulative += metrics.stepBuckets[bucket];
+        appendf(out, "%s_bucket{le=\"%g\"} %llu\n", histogram, EngineMetrics::STEP_BUCKET_BOUNDS[bucket],
+                static_cast<unsigned long long>(cumulative));
+    }
+    appendf(out, "%s_bucket{le=\"+Inf\"} %llu\n", histogram, static_cast<unsigned long long>(metrics.stepCount));
+    appendf(out, "%s_sum %.17g\n", histogram, metrics.stepSeconds);
+    appendf(out, "%s_count %llu\n", histogram, static_cast<unsigned long long>(metrics.stepCount));
+    return out;
+}
+
+MetricsExporter::MetricsExporter(const MetricsPublisher& source, uint16_t listenPort)
+    : publisher(source), port(listenPort), listenSocket(-1), running(false), scrapes(0) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+#ifdef METRICS_HTTP_SUPPORTED
+
+bool MetricsExporter::start() {
+    if (isRunning()) {
+        return true;
+    }
+
+    listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return false;
+    }
+    int reuse = 1;
+    ::setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Loopback only: the endpoint is for local scrapers and has no authentication
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenSocket, 8) != 0 ||
+        ::getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    port = ntohs(address.sin_port);
+
+    running.store(true, std::memory_order_release);
+    serverThread = std::thread(&MetricsExporter::serve, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    serverThread.join();
+    ::close(listenSocket);
+    listenSocket = -1;
+}
+
+void MetricsExporter::serve() {
+    // Poll with a timeout so stop() is noticed without closing the socket under accept()
+    pollfd descriptor{};
+    descriptor.fd = listenSocket;
+    descriptor.events = POLLIN;
+    while (running.load(std::memory_order_acquire)) {
+        descriptor.revents = 0;
+        if (::poll(&descriptor, 1, 100) <= 0 || !(descriptor.revents & POLLIN)) {
+            continue;
+        }
+        int connection = ::accept(listenSocket, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        handleConnection(connection);
+        ::close(connection);
+    }
+}
+
+void MetricsExporter::handleConnection(int connection) {
+    // A slow or silent client must not hold up the next scrape for long
+    timeval timeout{};
+    timeout.tv_sec = 1;
+    ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters; read until the end of the headers
+    char request[2048];
+    size_t received = 0;
+    while (received < sizeof(request) - 1) {
+        ssize_t count = ::recv(connection, request + received, sizeof(request) - 1 - received, 0);
+        if (count <= 0) {
+            break;
+        }
+        received += static_cast<size_t>(count);
+        request[received] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) {
+            break;
+        }
+    }
+    request[received] = '\0';
+
+    std::string body;
+    const char* status = "200 OK";
+    const char* contentType = "text/plain; version=0.0.4; charset=utf-8";
+    if (std::strncmp(request, "GET /metrics ", 13) == 0 || std::strncmp(request, "GET /metrics?", 13) == 0) {
+        EngineMetrics metrics;
+        publisher.read(metrics);
+        body = render(metrics, publisher.getPublishCount());
+        scrapes.fetch_add(1, std::memory_order_relaxed);
+    } else if (std::strncmp(request, "GET ", 4) == 0) {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = "metrics are served at /metrics\n";
+    } else {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain; charset=utf-8";
+        body = "only GET is supported\n";
+    }
+
+    char headers[256];
+    int headerLength = std::snprintf(headers, sizeof(headers),
+                                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                                     status, contentType, body.size());
+    std::string response(headers, static_cast<size_t>(headerLength));
+    response += body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t count = ::send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(count);
+    }
+}
+
+#else
+
+bool MetricsExporter::start() {
+    return false;
+}
+
+void MetricsExporter::stop() {
+    running.store(false);
+}
+
+void MetricsExporter::serve() {}
+
+void MetricsExporter::handleConnection(int) {}
+
+#endif
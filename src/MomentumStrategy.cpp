@@ -27,18 +27,21 @@ public:
 
     void onTick(Market &market, Portfolio &portfolio, TradingEngine &engine, int /*step*/) override
     {
-        for (const auto &sym : market.getAvailableSymbols())
+        const MarketSnapshot &snap = market.getSnapshot();
+        const std::vector<std::string> &symbols = market.getSymbolsByIndex();
+
+        for (size_t i = 0; i < snap.size(); ++i)
         {
-            double daily = market.getDailyReturn(sym);
+            double daily = snap.returns[i] * 100.0; // same units as Market::getDailyReturn
             if (daily > returnThreshold)
             {
                 // Buy on positive momentum
-                engine.executeMarketOrder(sym, OrderType::BUY, orderQty);
+                engine.executeMarketOrder(symbols[i], OrderType::BUY, orderQty);
             }
-            else if (daily < -returnThreshold && portfolio.hasPosition(sym))
+            else if (daily < -returnThreshold && portfolio.hasPosition(symbols[i]))
             {
                 // Sell some on negative momentum
-                engine.executeMarketOrder(sym, OrderType::SELL, std::max(1.0, orderQty / 2.0));
+                engine.executeMarketOrder(symbols[i], OrderType::SELL, std::max(1.0, orderQty / 2.0));
             }
         }
     }
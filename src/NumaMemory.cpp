@@ -0,0 +1,180 @@
+#include "NumaMemory.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#endif
+
+namespace {
+// "0-3,8-11" as listed in sysfs
+std::vector<size_t> parseCpuList(const std::string& list) {
+    std::vector<size_t> cpus;
+    size_t position = 0;
+    while (position < list.size()) {
+        size_t end = list.find(',', position);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string range = list.substr(position, end - position);
+        size_t dash = range.find('-');
+        try {
+            size_t first = std::stoul(range.substr(0, dash));
+            size_t last = (dash == std::string::npos) ? first : std::stoul(range.substr(dash + 1));
+            for (size_t cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            // Blank or malformed entry
+        }
+        position = end + 1;
+    }
+    return cpus;
+}
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+}
+
+NumaTopology::NumaTopology() {
+#ifdef __linux__
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string nodeList;
+    if (online && std::getline(online, nodeList)) {
+        for (size_t node : parseCpuList(nodeList)) {
+            std::ifstream cpuFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string cpuList;
+            std::vector<size_t> cpus;
+            if (cpuFile && std::getline(cpuFile, cpuList)) {
+                cpus = parseCpuList(cpuList);
+            }
+            // Memory-only nodes have no CPUs to run workers on
+            if (!cpus.empty()) {
+                cpusByNode.push_back(std::move(cpus));
+                nodeIds.push_back(node);
+            }
+        }
+    }
+#endif
+    if (cpusByNode.empty()) {
+        std::vector<size_t> cpus(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t cpu = 0; cpu < cpus.size(); ++cpu) {
+            cpus[cpu] = cpu;
+        }
+        cpusByNode.push_back(std::move(cpus));
+        nodeIds.push_back(0);
+    }
+
+    for (size_t node = 0; node < cpusByNode.size(); ++node) {
+        for (size_t cpu : cpusByNode[node]) {
+            if (cpu >= nodeByCpu.size()) {
+                nodeByCpu.resize(cpu + 1, 0);
+            }
+            nodeByCpu[cpu] = node;
+        }
+    }
+}
+
+const NumaTopology& NumaTopology::get() {
+    static const NumaTopology topology;
+    return topology;
+}
+
+size_t NumaTopology::getCurrentNode() const {
+#ifdef __linux__
+    int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return getNodeOfCpu(static_cast<size_t>(cpu));
+    }
+#endif
+    return 0;
+}
+
+std::vector<size_t> NumaTopology::selectCpus(size_t count, bool spread) const {
+    std::vector<size_t> selected;
+    selected.reserve(count);
+    if (spread) {
+        std::vector<size_t> next(cpusByNode.size(), 0);
+        for (size_t i = 0; i < count; ++i) {
+            size_t node = i % cpusByNode.size();
+            const std::vector<size_t>& cpus = cpusByNode[node];
+            selected.push_back(cpus[next[node]++ % cpus.size()]);
+        }
+    } else {
+        std::vector<size_t> all;
+        for (const auto& cpus : cpusByNode) {
+            all.insert(all.end(), cpus.begin(), cpus.end());
+        }
+        for (size_t i = 0; i < count; ++i) {
+            selected.push_back(all[i % all.size()]);
+        }
+    }
+    return selected;
+}
+
+NodeLocalResource::NodeLocalResource(size_t numaNode, size_t chunkSize)
+    : node(numaNode), chunkBytes(std::max<size_t>(chunkSize, 64 << 10)), cursor(nullptr), limit(nullptr),
+      mappedBytes(0), bound(false) {}
+
+NodeLocalResource::~NodeLocalResource() {
+    for (const Chunk& chunk : chunks) {
+#ifdef __linux__
+        munmap(chunk.memory, chunk.bytes);
+#else
+        ::operator delete(chunk.memory, std::align_val_t(CACHE_LINE_SIZE));
+#endif
+    }
+}
+
+void* NodeLocalResource::do_allocate(size_t bytes, size_t alignment) {
+    alignment = std::max<size_t>(alignment, alignof(std::max_align_t));
+    char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(cursor), alignment));
+    if (!cursor || aligned + bytes > limit) {
+        addChunk(bytes + alignment);
+        aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(cursor), alignment));
+    }
+    cursor = aligned + bytes;
+    return aligned;
+}
+
+void NodeLocalResource::addChunk(size_t minimumBytes) {
+#ifdef __linux__
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t bytes = roundUp(std::max(chunkBytes, minimumBytes), pageSize);
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    // Prefer the node before any page is touched; on one-node machines (or
+    // if the kernel refuses) pages land where the running thread first
+    // touches them, which is the worker's node as well
+    const NumaTopology& topology = NumaTopology::get();
+    if (topology.getNodeCount() > 1 && node < topology.getNodeCount()) {
+        const size_t bitsPerWord = 8 * sizeof(unsigned long);
+        size_t nodeId = topology.getNodeId(node);
+        std::vector<unsigned long> mask(nodeId / bitsPerWord + 1, 0);
+        mask[nodeId / bitsPerWord] |= 1UL << (nodeId % bitsPerWord);
+        bound = syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED, mask.data(), mask.size() * bitsPerWord + 1, 0) == 0;
+    }
+#else
+    size_t bytes = roundUp(std::max(chunkBytes, minimumBytes), CACHE_LINE_SIZE);
+    void* memory = ::operator new(bytes, std::align_val_t(CACHE_LINE_SIZE));
+#endif
+    chunks.push_back({memory, bytes});
+    mappedBytes += bytes;
+    cursor = static_cast<char*>(memory);
+    limit = cursor + bytes;
+}
+
+SimulationArena::SimulationArena(size_t numaNode, size_t chunkSize)
+    : chunks(numaNode, chunkSize), pool(&chunks) {}
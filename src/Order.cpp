@@ -1,13 +1,13 @@
 #include "Order.h"
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
 
-int Order::nextOrderId = 1;
+std::atomic<int> Order::nextOrderId{1};
 
 Order::Order(const std::string& symbol, OrderType type, double quantity, double price)
-    : orderId(nextOrderId++), symbol(symbol), type(type), quantity(quantity), 
+    : orderId(nextOrderId.fetch_add(1, std::memory_order_relaxed)), symbol(symbol), type(type), quantity(quantity), 
       price(price), filledQuantity(0.0), status(OrderStatus::PENDING),
-      timestamp(std::chrono::system_clock::now()) {}
+      timestamp(std::chrono::system_clock::now()), executionType(ExecutionType::LIMIT),
+      timeInForce(TimeInForce::GTC), stopPrice(0.0), trailAmount(0.0), expiryStep(-1) {}
 
 void Order::fillOrder(double fillQuantity) {
     if (fillQuantity <= 0 || fillQuantity > getRemainingQuantity()) {
@@ -24,21 +24,34 @@ void Order::fillOrder(double fillQuantity) {
 }
 
 std::string Order::toString() const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2);
-    oss << "Order #" << orderId << " - " << symbol << " ";
-    oss << (type == OrderType::BUY ? "BUY" : "SELL") << " ";
-    oss << quantity << " @ $" << price << " ";
-    oss << "(Filled: " << filledQuantity << "/" << quantity << ") ";
+    char buffer[FORMAT_BUFFER_SIZE];
+    format(buffer, sizeof(buffer));
+    return buffer;
+}
+
+size_t Order::format(char* buffer, size_t size) const {
+    const char* side = (type == OrderType::BUY) ? "BUY" : "SELL";
+    
+    char trigger[48] = "";
+    switch (executionType) {
+        case ExecutionType::MARKET: std::snprintf(trigger, sizeof(trigger), "MKT "); break;
+        case ExecutionType::LIMIT: break;
+        case ExecutionType::STOP: std::snprintf(trigger, sizeof(trigger), "STOP $%.2f ", stopPrice); break;
+        case ExecutionType::STOP_LIMIT: std::snprintf(trigger, sizeof(trigger), "STOP_LIMIT $%.2f ", stopPrice); break;
+        case ExecutionType::TRAILING_STOP: std::snprintf(trigger, sizeof(trigger), "TRAIL $%.2f ", trailAmount); break;
+    }
     
-    std::string statusStr;
+    const char* statusStr = "";
     switch (status) {
         case OrderStatus::PENDING: statusStr = "PENDING"; break;
         case OrderStatus::FILLED: statusStr = "FILLED"; break;
         case OrderStatus::CANCELLED: statusStr = "CANCELLED"; break;
         case OrderStatus::PARTIALLY_FILLED: statusStr = "PARTIALLY_FILLED"; break;
+        case OrderStatus::EXPIRED: statusStr = "EXPIRED"; break;
     }
-    oss << "[" << statusStr << "]";
     
-    return oss.str();
+    int written = std::snprintf(buffer, size, "Order #%d - %s %s %.2f @ $%.2f %s(Filled: %.2f/%.2f) [%s]",
+                                orderId, symbol.c_str(), side, quantity, price, trigger,
+                                filledQuantity, quantity, statusStr);
+    return written > 0 ? static_cast<size_t>(written) : 0;
 }
@@ -0,0 +1,192 @@
+#include "OrderBook.h"
+
+void OrderBook::addResting(const Order &order)
+{
+    Entry entry{};
+    entry.location = Location::RESTING;
+    entry.resting = resting.insert(resting.end(), order);
+    index[order.getOrderId()] = entry;
+}
+
+void OrderBook::addStop(const Order &order)
+{
+    Entry entry{};
+    if (order.getType() == OrderType::BUY)
+    {
+        entry.location = Location::BUY_STOP;
+        entry.buyStop = buyStops.emplace(order.getStopPrice(), order);
+    }
+    else
+    {
+        entry.location = Location::SELL_STOP;
+        entry.sellStop = sellStops.emplace(order.getStopPrice(), order);
+    }
+    index[order.getOrderId()] = entry;
+}
+
+void OrderBook::addTrailingStop(const Order &order, double referencePrice)
+{
+    TrailingSide &side = trailingSide(order);
+    double extreme = (&side == &sellTrailing) ? referencePrice : -referencePrice;
+    auto group = side.groups.find(extreme);
+    if (group == side.groups.end())
+    {
+        group = side.groups.emplace(extreme, TrailGroup{extreme, TrailBook(&pool), side.levels.end()}).first;
+    }
+
+    Entry entry{};
+    entry.location = Location::TRAILING;
+    entry.trailing = group->second.orders.emplace(order.getTrailAmount(), order);
+    entry.trailGroup = &group->second;
+    index[order.getOrderId()] = entry;
+    relevel(side, &group->second);
+}
+
+void OrderBook::relevel(TrailingSide &side, TrailGroup *group)
+{
+    // The group's highest stop level belongs to its smallest trail
+    double level = group->extreme - group->orders.begin()->first;
+    if (group->level == side.levels.end())
+    {
+        group->level = side.levels.emplace(level, group);
+    }
+    else if (group->level->first != level)
+    {
+        auto node = side.levels.extract(group->level);
+        node.key() = level;
+        group->level = side.levels.insert(std::move(node));
+    }
+}
+
+void OrderBook::removeFromGroup(TrailingSide &side, TrailGroup *group, TrailBook::iterator it)
+{
+    group->orders.erase(it);
+    if (group->orders.empty())
+    {
+        side.levels.erase(group->level);
+        side.groups.erase(group->extreme);
+    }
+    else
+    {
+        relevel(side, group);
+    }
+}
+
+std::optional<Order> OrderBook::remove(int orderId)
+{
+    auto it = index.find(orderId);
+    if (it == index.end())
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Order> removed;
+    Entry &entry = it->second;
+    switch (entry.location)
+    {
+    case Location::RESTING:
+        removed = *entry.resting;
+        resting.erase(entry.resting);
+        break;
+    case Location::BUY_STOP:
+        removed = entry.buyStop->second;
+        buyStops.erase(entry.buyStop);
+        break;
+    case Location::SELL_STOP:
+        removed = entry.sellStop->second;
+        sellStops.erase(entry.sellStop);
+        break;
+    case Location::TRAILING:
+        removed = entry.trailing->second;
+        removeFromGroup(trailingSide(*removed), entry.trailGroup, entry.trailing);
+        break;
+    }
+
+    index.erase(it);
+    return removed;
+}
+
+void OrderBook::collectTriggered(double price, std::vector<Order> &triggered)
+{
+    while (!buyStops.empty() && buyStops.begin()->first <= price)
+    {
+        triggered.push_back(buyStops.begin()->second);
+        index.erase(buyStops.begin()->second.getOrderId());
+        buyStops.erase(buyStops.begin());
+    }
+
+    while (!sellStops.empty() && sellStops.begin()->first >= price)
+    {
+        triggered.push_back(sellStops.begin()->second);
+        index.erase(sellStops.begin()->second.getOrderId());
+        sellStops.erase(sellStops.begin());
+    }
+
+    // Buy stops trail the low, so they are kept on negated prices
+    collectTrailing(sellTrailing, price, triggered);
+    collectTrailing(buyTrailing, -price, triggered);
+}
+
+void OrderBook::collectTrailing(TrailingSide &side, double price, std::vector<Order> &triggered)
+{
+    // Every group the price has reached now trails the price: merge them
+    // into the largest one, which is rekeyed in place
+    auto first = side.groups.begin();
+    if (first != side.groups.end() && first->first <= price)
+    {
+        auto last = side.groups.upper_bound(price);
+        auto largest = first;
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second.orders.size() > largest->second.orders.size())
+            {
+                largest = it;
+            }
+        }
+
+        TrailGroup *target = &largest->second;
+        for (auto it = first; it != last;)
+        {
+            if (it == largest)
+            {
+                ++it;
+                continue;
+            }
+            for (auto &pair : it->second.orders)
+            {
+                index.find(pair.second.getOrderId())->second.trailGroup = target;
+            }
+            target->orders.merge(it->second.orders);
+            side.levels.erase(it->second.level);
+            it = side.groups.erase(it);
+        }
+
+        auto node = side.groups.extract(largest);
+        node.key() = price;
+        node.mapped().extreme = price;
+        side.groups.insert(std::move(node));
+        relevel(side, target);
+    }
+
+    // Fire the smallest trails of each group whose highest level is crossed
+    while (!side.levels.empty() && side.levels.begin()->first >= price)
+    {
+        TrailGroup *group = side.levels.begin()->second;
+        while (!group->orders.empty() && group->extreme - group->orders.begin()->first >= price)
+        {
+            triggered.push_back(group->orders.begin()->second);
+            index.erase(group->orders.begin()->second.getOrderId());
+            group->orders.erase(group->orders.begin());
+        }
+
+        if (group->orders.empty())
+        {
+            side.levels.erase(group->level);
+            side.groups.erase(group->extreme);
+        }
+        else
+        {
+            relevel(side, group);
+        }
+    }
+}
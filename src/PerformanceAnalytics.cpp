@@ -0,0 +1,125 @@
+#include "PerformanceAnalytics.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+PerformanceAnalytics::PerformanceAnalytics(double initialEquity, double periodsPerYear)
+    : periodsPerYear(periodsPerYear), initialEquity(initialEquity), lastEquity(initialEquity),
+      peakEquity(initialEquity), currentDrawdown(0.0), maxDrawdown(0.0), equitySum(0.0),
+      periods(0), meanReturn(0.0), m2Return(0.0), downsideSumSq(0.0),
+      tradedNotional(0.0), grossExposure(0.0), netExposure(0.0),
+      grossExposureSum(0.0), netExposureSum(0.0) {}
+
+void PerformanceAnalytics::recordEquity(double equity, double gross, double net) {
+    if (lastEquity > 0.0) {
+        double periodReturn = equity / lastEquity - 1.0;
+        ++periods;
+        double delta = periodReturn - meanReturn;
+        meanReturn += delta / static_cast<double>(periods);
+        m2Return += delta * (periodReturn - meanReturn);
+        if (periodReturn < 0.0) {
+            downsideSumSq += periodReturn * periodReturn;
+        }
+    }
+
+    lastEquity = equity;
+    peakEquity = std::max(peakEquity, equity);
+    currentDrawdown = (peakEquity > 0.0) ? (peakEquity - equity) / peakEquity : 0.0;
+    maxDrawdown = std::max(maxDrawdown, currentDrawdown);
+    equitySum += equity;
+
+    grossExposure = gross;
+    netExposure = net;
+    grossExposureSum += gross;
+    netExposureSum += net;
+}
+
+void PerformanceAnalytics::recordFill(const std::string& symbol, double signedQuantity, double price) {
+    tradedNotional += std::abs(signedQuantity) * price;
+
+    // Attribute the difference between the fill and the last mark; later marks
+    // attribute the price moves, so the sum over symbols equals total PnL.
+    auto it = lastMark.find(symbol);
+    if (it == lastMark.end()) {
+        lastMark[symbol] = price;
+        symbolPnL.emplace(symbol, 0.0);
+    } else {
+        symbolPnL[symbol] += signedQuantity * (it->second - price);
+    }
+}
+
+void PerformanceAnalytics::recordMark(const std::string& symbol, double positionQuantity, double price) {
+    auto it = lastMark.find(symbol);
+    if (it == lastMark.end()) {
+        lastMark[symbol] = price;
+        return;
+    }
+    if (positionQuantity != 0.0) {
+        symbolPnL[symbol] += positionQuantity * (price - it->second);
+    }
+    it->second = price;
+}
+
+void PerformanceAnalytics::recordCost(const std::string& symbol, double amount) {
+    symbolPnL[symbol] -= amount;
+}
+
+double PerformanceAnalytics::getReturnVolatility() const {
+    if (periods < 2) {
+        return 0.0;
+    }
+    return std::sqrt(m2Return / static_cast<double>(periods - 1));
+}
+
+double PerformanceAnalytics::getSharpeRatio() const {
+    double vol = getReturnVolatility();
+    return (vol > 0.0) ? meanReturn / vol * std::sqrt(periodsPerYear) : 0.0;
+}
+
+double PerformanceAnalytics::getSortinoRatio() const {
+    if (periods == 0) {
+        return 0.0;
+    }
+    double downsideDeviation = std::sqrt(downsideSumSq / static_cast<double>(periods));
+    return (downsideDeviation > 0.0) ? meanReturn / downsideDeviation * std::sqrt(periodsPerYear) : 0.0;
+}
+
+double PerformanceAnalytics::getTurnover() const {
+    // Average over the initial equity and every recorded snapshot
+    double averageEquity = (initialEquity + equitySum) / static_cast<double>(periods + 1);
+    return (averageEquity > 0.0) ? tradedNotional / averageEquity : 0.0;
+}
+
+double PerformanceAnalytics::getAverageGrossExposure() const {
+    return (periods > 0) ? grossExposureSum / static_cast<double>(periods) : grossExposure;
+}
+
+double PerformanceAnalytics::getAverageNetExposure() const {
+    return (periods > 0) ? netExposureSum / static_cast<double>(periods) : netExposure;
+}
+
+double PerformanceAnalytics::getSymbolPnL(const std::string& symbol) const {
+    auto it = symbolPnL.find(symbol);
+    return (it != symbolPnL.end()) ? it->second : 0.0;
+}
+
+void PerformanceAnalytics::printSummary() const {
+    std::cout << "\n=== Performance Summary ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Periods: " << periods << std::endl;
+    std::cout << "Peak Equity: $" << peakEquity << std::endl;
+    std::cout << "Max Drawdown: " << maxDrawdown * 100.0 << "%" << std::endl;
+    std::cout << "Sharpe Ratio: " << getSharpeRatio() << std::endl;
+    std::cout << "Sortino Ratio: " << getSortinoRatio() << std::endl;
+    std::cout << "Turnover: " << getTurnover() << "x" << std::endl;
+    std::cout << "Avg Gross Exposure: $" << getAverageGrossExposure() << std::endl;
+
+    if (!symbolPnL.empty()) {
+        std::cout << "\nPnL Attribution:" << std::endl;
+        for (const auto& pair : symbolPnL) {
+            std::cout << pair.first << ": $" << pair.second << std::endl;
+        }
+    }
+    std::cout << "===========================\n" << std::endl;
+}
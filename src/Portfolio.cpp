@@ -2,75 +2,503 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
-Portfolio::Portfolio(double initialCash) : cash(initialCash), totalValue(initialCash) {}
+Portfolio::Portfolio(double initialCash, const std::string& baseCurrency)
+    : initialCash(initialCash), totalValue(initialCash), baseCurrency(baseCurrency),
+      defaultInstrument("", 0.01, 1.0, baseCurrency), lotMatching(LotMatching::AVERAGE_COST),
+      keepClosedLots(false), keepOrderHistory(true),
+      allowShortSelling(false), analytics(initialCash), grossExposure(0.0), derivativesValue(0.0),
+      derivativesCashFlow(0.0) {
+    cashBalances[baseCurrency] = toMoney(initialCash);
+}
 
-bool Portfolio::canAffordOrder(const Order& order) const {
-    if (order.getType() == OrderType::BUY) {
-        double orderValue = order.getQuantity() * order.getPrice();
-        return cash >= orderValue;
-    } else {
-        // For sell orders, check if we have enough position
-        return getPositionQuantity(order.getSymbol()) >= order.getQuantity();
+bool Portfolio::canAffordOrder(const Order& order, double fee, const Reservation* held, double executionPrice) const {
+    const Instrument& instrument = getInstrument(order.getSymbol());
+    Lots lots = instrument.toLots(order.getQuantity());
+    if (lots <= 0 || !instrument.isWholeLots(order.getQuantity()) || !hasFxRate(instrument.currency)) {
+        return false;
+    }
+    bool isBuy = order.getType() == OrderType::BUY;
+    Ticks ticks = instrument.toTicks(executionPrice > 0.0 ? executionPrice : order.getPrice());
+    
+    if (!isMarginAccount()) {
+        auto it = cashBalances.find(instrument.currency);
+        auto reserved = reservedCash.find(instrument.currency);
+        Money available = (it != cashBalances.end() ? it->second : 0) -
+                          (reserved != reservedCash.end() ? reserved->second : 0);
+        if (held) {
+            available += held->cash;
+        }
+        if (isBuy) {
+            return available >= instrument.notional(ticks, lots) + toMoney(fee);
+        }
+        // Sells need an unpromised long position unless short selling is allowed,
+        // and the proceeds plus free cash must cover the fee
+        if (!allowShortSelling && closableLots(order, lots, held) != lots) {
+            return false;
+        }
+        return available + instrument.notional(ticks, lots) >= toMoney(fee);
+    }
+    
+    // Margin account: only the part that opens or extends a position needs margin
+    Lots opening = lots - closableLots(order, lots, held);
+    if (opening == 0) {
+        return true;
+    }
+    if (!isBuy && !allowShortSelling) {
+        return false;
+    }
+    Money required = initialMarginFor(instrument.notional(ticks, opening)) + toMoney(fee);
+    double excess = totalValue - grossExposure / marginPolicy.leverage - reservedInBase();
+    if (held) {
+        excess += toBase(instrument.currency, held->cash);
     }
+    return excess >= toBase(instrument.currency, required);
 }
 
-void Portfolio::executeOrder(const Order& order, double executionPrice) {
-    if (!canAffordOrder(order)) {
-        return; // Cannot execute order
+bool Portfolio::executeOrder(const Order& order, double executionPrice, double fee, const Reservation* held) {
+    if (!canAffordOrder(order, fee, held, executionPrice)) {
+        return false;
     }
     
     const std::string& symbol = order.getSymbol();
-    double quantity = order.getQuantity();
+    const Instrument& instrument = getInstrument(symbol);
+    Lots lots = instrument.toLots(order.getQuantity());
+    Ticks ticks = instrument.toTicks(executionPrice);
+    Money notional = instrument.notional(ticks, lots);
+    bool isBuy = order.getType() == OrderType::BUY;
+    Lots delta = isBuy ? lots : -lots;
     
-    if (order.getType() == OrderType::BUY) {
-        // Buy order
-        double orderValue = quantity * executionPrice;
-        updateCash(-orderValue);
-        
-        if (positions.find(symbol) == positions.end()) {
-            positions[symbol] = Position(symbol, 0.0, 0.0);
+    updateCash(instrument.currency, isBuy ? -notional : notional);
+    
+    auto it = positions.find(symbol);
+    if (it == positions.end()) {
+        it = openPosition(symbol);
+        it->second.currency = instrument.currency;
+        it->second.markTicks = ticks;
+    }
+    Position& pos = it->second;
+    
+    if (pos.lots == 0 || (pos.lots > 0) == isBuy) {
+        // Opening or adding: cost basis grows by the signed notional
+        pos.costBasis += isBuy ? notional : -notional;
+        pos.lots += delta;
+        if (lotMatching != LotMatching::AVERAGE_COST) {
+            addLot(pos, lots, notional, ticks, order.getOrderId());
         }
-        
-        Position& pos = positions[symbol];
-        // Update average price using weighted average
-        if (pos.quantity > 0) {
-            double totalCost = (pos.quantity * pos.averagePrice) + (quantity * executionPrice);
-            pos.quantity += quantity;
-            pos.averagePrice = totalCost / pos.quantity;
+    } else {
+        // Reducing, closing or flipping: realize PnL on the closed part, at
+        // average cost or against the lots the matching method closes
+        Lots held = pos.lots > 0 ? pos.lots : -pos.lots;
+        Lots closing = std::min(lots, held);
+        Money closedCost;
+        if (lotMatching != LotMatching::AVERAGE_COST) {
+            closedCost = closeLots(pos, instrument, closing, ticks, order.getOrderId());
+            if (pos.lots < 0) {
+                closedCost = -closedCost;
+            }
+        } else if (closing == held) {
+            closedCost = pos.costBasis;
         } else {
-            pos.quantity = quantity;
-            pos.averagePrice = executionPrice;
+            closedCost = static_cast<Money>(std::llround(static_cast<long double>(pos.costBasis) * closing / held));
         }
-    } else {
-        // Sell order
-        Position& pos = positions[symbol];
-        double saleValue = quantity * executionPrice;
-        updateCash(saleValue);
-        
-        // Calculate realized P&L
-        double realizedPnL = quantity * (executionPrice - pos.averagePrice);
-        pos.realizedPnL += realizedPnL;
-        pos.quantity -= quantity;
+        Money closingValue = instrument.notional(ticks, closing);
+        if (pos.lots < 0) {
+            closingValue = -closingValue;
+        }
+        pos.realized += closingValue - closedCost;
+        pos.costBasis -= closedCost;
+        pos.lots += isBuy ? closing : -closing;
         
-        // Remove position if quantity becomes zero
-        if (pos.quantity <= 0.001) { // Use small epsilon for floating point comparison
-            positions.erase(symbol);
+        Lots remaining = lots - closing;
+        if (remaining > 0) {
+            pos.lots = isBuy ? remaining : -remaining;
+            pos.costBasis = isBuy ? instrument.notional(ticks, remaining) : -instrument.notional(ticks, remaining);
+            if (lotMatching != LotMatching::AVERAGE_COST) {
+                addLot(pos, remaining, instrument.notional(ticks, remaining), ticks, order.getOrderId());
+            }
         }
     }
     
+    Money feeMoney = toMoney(fee);
+    if (feeMoney != 0) {
+        updateCash(instrument.currency, -feeMoney);
+        pos.fees += feeMoney;
+        pos.realized -= feeMoney;
+    }
+    refreshPosition(pos, instrument);
+    
+    double fx = getFxRate(instrument.currency);
+    analytics.recordFill(symbol, instrument.fromLots(delta), instrument.fromTicks(ticks) * fx);
+    if (feeMoney != 0) {
+        analytics.recordCost(symbol, toBase(instrument.currency, feeMoney));
+    }
+    
+    // Remove position once it is exactly flat
+    if (pos.lots == 0) {
+        closePosition(it);
+    }
+    
     // Add to order history
-    orderHistory.push_back(order);
+    if (keepOrderHistory) {
+        orderHistory.push_back(order);
+        orderHistory.back().fillOrder(order.getRemainingQuantity());
+    }
     updateTotalValue();
+    return true;
+}
+
+std::map<std::string, Position>::iterator Portfolio::openPosition(const std::string& symbol) {
+    if (spareNodes.nodes.empty()) {
+        return positions.emplace(symbol, Position(symbol)).first;
+    }
+    
+    // Reuse a closed position's node; the assignments keep string and lot capacity
+    auto node = std::move(spareNodes.nodes.back());
+    spareNodes.nodes.pop_back();
+    TaxLotQueue lots = std::move(node.mapped().taxLots);
+    lots.clear();
+    node.key() = symbol;
+    node.mapped() = Position(symbol);
+    node.mapped().taxLots = std::move(lots);
+    return positions.insert(std::move(node)).position;
+}
+
+void Portfolio::closePosition(std::map<std::string, Position>::iterator it) {
+    const Position& pos = it->second;
+    ClosedPnL& closed = closedPnL[it->first];
+    closed.currency = pos.currency;
+    closed.realized += pos.realized;
+    closed.fees += pos.fees;
+    closed.borrowCost += pos.borrowCost;
+    spareNodes.nodes.push_back(positions.extract(it));
+}
+
+void Portfolio::addLot(Position& pos, Lots lots, Money cost, Ticks ticks, int orderId) {
+    // Partial fills of one order at one price extend the same lot
+    if (!pos.taxLots.empty()) {
+        TaxLot& last = pos.taxLots.back();
+        if (last.orderId == orderId && last.entryTicks == ticks) {
+            last.lots += lots;
+            last.cost += cost;
+            return;
+        }
+    }
+    pos.taxLots.push_back({lots, cost, ticks, orderId});
+}
+
+Money Portfolio::closeLots(Position& pos, const Instrument& instrument, Lots lots, Ticks ticks, int orderId) {
+    // Returns the (positive) cost basis of the lots closed
+    bool fifo = lotMatching == LotMatching::FIFO;
+    bool isShort = pos.lots < 0;
+    Money closedCost = 0;
+    while (lots > 0 && !pos.taxLots.empty()) {
+        TaxLot& lot = fifo ? pos.taxLots.front() : pos.taxLots.back();
+        Lots taken = std::min(lots, lot.lots);
+        Money cost = (taken == lot.lots)
+            ? lot.cost
+            : static_cast<Money>(std::llround(static_cast<long double>(lot.cost) * taken / lot.lots));
+        if (keepClosedLots) {
+            Money value = instrument.notional(ticks, taken);
+            closedLots.push_back({pos.symbol, lot.orderId, orderId,
+                                  instrument.fromLots(isShort ? -taken : taken),
+                                  instrument.fromTicks(lot.entryTicks), instrument.fromTicks(ticks),
+                                  fromMoney(isShort ? cost - value : value - cost)});
+        }
+        closedCost += cost;
+        lots -= taken;
+        lot.lots -= taken;
+        lot.cost -= cost;
+        if (lot.lots == 0) {
+            if (fifo) {
+                pos.taxLots.pop_front();
+            } else {
+                pos.taxLots.pop_back();
+            }
+        }
+    }
+    return closedCost;
+}
+
+void Portfolio::setLotMatching(LotMatching method) {
+    if (method == lotMatching) {
+        return;
+    }
+    for (auto& pair : positions) {
+        Position& pos = pair.second;
+        pos.taxLots.clear();
+        if (method != LotMatching::AVERAGE_COST && pos.lots != 0) {
+            Lots lots = pos.lots < 0 ? -pos.lots : pos.lots;
+            Money cost = pos.costBasis < 0 ? -pos.costBasis : pos.costBasis;
+            const Instrument& instrument = getInstrument(pair.first);
+            addLot(pos, lots, cost, instrument.toTicks(pos.averagePrice), 0);
+        }
+    }
+    lotMatching = method;
 }
 
 void Portfolio::updatePositionValue(const std::string& symbol, double currentPrice) {
+    const Instrument& instrument = getInstrument(symbol);
     auto it = positions.find(symbol);
     if (it != positions.end()) {
         Position& pos = it->second;
-        pos.unrealizedPnL = pos.quantity * (currentPrice - pos.averagePrice);
+        pos.markTicks = instrument.toTicks(currentPrice);
+        refreshPosition(pos, instrument);
+    }
+    // Marks are recorded for flat symbols too so a later fill is attributed
+    // against a fresh price; symbols in a currency without a rate cannot be
+    // traded, so they have nothing to attribute
+    if (hasFxRate(instrument.currency)) {
+        analytics.recordMark(symbol, (it != positions.end()) ? it->second.quantity : 0.0,
+                             currentPrice * getFxRate(instrument.currency));
+    }
+    updateTotalValue();
+}
+
+void Portfolio::registerInstrument(const Instrument& instrument) {
+    instruments[instrument.symbol] = instrument;
+}
+
+const Instrument& Portfolio::getInstrument(const std::string& symbol) const {
+    auto it = instruments.find(symbol);
+    return (it != instruments.end()) ? it->second : defaultInstrument;
+}
+
+void Portfolio::setFxRate(const std::string& currency, double rateToBase) {
+    if (currency != baseCurrency && rateToBase > 0.0) {
+        fxRates[currency] = rateToBase;
+        updateTotalValue();
+    }
+}
+
+bool Portfolio::hasFxRate(const std::string& currency) const {
+    return currency == baseCurrency || fxRates.find(currency) != fxRates.end();
+}
+
+double Portfolio::getFxRate(const std::string& currency) const {
+    if (currency == baseCurrency) {
+        return 1.0;
+    }
+    auto it = fxRates.find(currency);
+    if (it == fxRates.end()) {
+        // A zero rate would silently drop the balance from every valuation
+        throw std::out_of_range("No FX rate for currency " + currency);
+    }
+    return it->second;
+}
+
+void Portfolio::deposit(const std::string& currency, double amount) {
+    double rate = getFxRate(currency);
+    updateCash(currency, toMoney(amount));
+    initialCash += amount * rate;
+    updateTotalValue();
+}
+
+bool Portfolio::convertCurrency(const std::string& from, const std::string& to, double amount) {
+    Money debit = toMoney(amount);
+    if (!hasFxRate(from) || !hasFxRate(to) || debit <= 0 || getCashBalance(from) < amount) {
+        return false;
     }
+    double fromRate = getFxRate(from);
+    double toRate = getFxRate(to);
+    updateCash(from, -debit);
+    updateCash(to, toMoney(amount * fromRate / toRate));
     updateTotalValue();
+    return true;
+}
+
+void Portfolio::settleDerivatives(double cashFlow, double bookValue) {
+    updateCash(baseCurrency, toMoney(cashFlow));
+    derivativesCashFlow += cashFlow;
+    derivativesValue = bookValue;
+    updateTotalValue();
+}
+
+void Portfolio::accrueBorrowCosts(double yearFraction) {
+    bool charged = false;
+    for (auto& pair : positions) {
+        Position& pos = pair.second;
+        if (pos.lots >= 0) {
+            continue;
+        }
+        const Instrument& instrument = getInstrument(pair.first);
+        Money shortValue = -instrument.notional(pos.markTicks, pos.lots);
+        Money cost = static_cast<Money>(std::llround(static_cast<double>(shortValue) * instrument.borrowRate * yearFraction));
+        if (cost <= 0) {
+            continue;
+        }
+        updateCash(pos.currency, -cost);
+        pos.borrowCost += cost;
+        pos.realized -= cost;
+        refreshPosition(pos, instrument);
+        analytics.recordCost(pair.first, toBase(pos.currency, cost));
+        charged = true;
+    }
+    if (charged) {
+        updateTotalValue();
+    }
+}
+
+void Portfolio::setMarginPolicy(const MarginPolicy& policy) {
+    marginPolicy = policy;
+    marginPolicy.leverage = std::max(1.0, policy.leverage);
+}
+
+Reservation Portfolio::reserveOrder(const Order& order, double fee) {
+    const Instrument& instrument = getInstrument(order.getSymbol());
+    Lots lots = instrument.toLots(order.getQuantity());
+    Reservation reservation;
+    if (lots <= 0) {
+        return reservation;
+    }
+    
+    bool isBuy = order.getType() == OrderType::BUY;
+    Ticks ticks = instrument.toTicks(order.getPrice());
+    if (!isMarginAccount()) {
+        if (isBuy) {
+            reservation.cash = instrument.notional(ticks, lots) + toMoney(fee);
+        } else if (!allowShortSelling) {
+            reservation.closeLots = lots;
+        }
+    } else {
+        reservation.closeLots = closableLots(order, lots, nullptr);
+        Lots opening = lots - reservation.closeLots;
+        reservation.cash = toMoney(fee);
+        if (opening > 0) {
+            reservation.cash += initialMarginFor(instrument.notional(ticks, opening));
+        }
+    }
+    
+    if (reservation.cash != 0) {
+        reservedCash[instrument.currency] += reservation.cash;
+    }
+    if (reservation.closeLots != 0) {
+        reservedCloseLots[order.getSymbol()] += reservation.closeLots;
+    }
+    return reservation;
+}
+
+void Portfolio::releaseOrder(const Order& order, const Reservation& reservation) {
+    if (reservation.cash != 0) {
+        auto it = reservedCash.find(getInstrument(order.getSymbol()).currency);
+        if (it != reservedCash.end()) {
+            it->second -= reservation.cash;
+        }
+    }
+    if (reservation.closeLots != 0) {
+        auto it = reservedCloseLots.find(order.getSymbol());
+        if (it != reservedCloseLots.end()) {
+            it->second -= reservation.closeLots;
+        }
+    }
+}
+
+double Portfolio::getReservedCash(const std::string& currency) const {
+    auto it = reservedCash.find(currency);
+    return (it != reservedCash.end()) ? fromMoney(it->second) : 0.0;
+}
+
+double Portfolio::getReservedCloseQuantity(const std::string& symbol) const {
+    auto it = reservedCloseLots.find(symbol);
+    return (it != reservedCloseLots.end()) ? getInstrument(symbol).fromLots(it->second) : 0.0;
+}
+
+MarginStatus Portfolio::getMarginStatus() const {
+    MarginStatus status;
+    status.equity = totalValue;
+    status.grossExposure = grossExposure;
+    status.initialMargin = grossExposure / marginPolicy.leverage;
+    status.reserved = reservedInBase();
+    status.excess = status.equity - status.initialMargin - status.reserved;
+    if (isMarginAccount()) {
+        status.maintenanceMargin = grossExposure * marginPolicy.maintenanceMargin;
+        status.marginCall = grossExposure > 0.0 && status.equity < status.maintenanceMargin;
+        status.liquidate = grossExposure > 0.0 && status.equity < grossExposure * marginPolicy.liquidationMargin;
+    }
+    return status;
+}
+
+bool Portfolio::isOverReserved() const {
+    for (const auto& pair : reservedCloseLots) {
+        if (pair.second <= 0) {
+            continue;
+        }
+        // Promised lots must still be held, on the side the orders close
+        auto it = positions.find(pair.first);
+        Lots held = (it != positions.end()) ? it->second.lots : 0;
+        if (pair.second > (held < 0 ? -held : held)) {
+            return true;
+        }
+    }
+    
+    if (isMarginAccount()) {
+        return totalValue - grossExposure / marginPolicy.leverage - reservedInBase() < 0.0;
+    }
+    for (const auto& pair : reservedCash) {
+        if (pair.second <= 0) {
+            continue;
+        }
+        auto it = cashBalances.find(pair.first);
+        if (it == cashBalances.end() || it->second < pair.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Portfolio::beginReservations() {
+    // Buying power already held for working orders is not promised again
+    for (const auto& pair : cashBalances) {
+        auto reserved = reservedCash.find(pair.first);
+        Money available = pair.second - (reserved != reservedCash.end() ? reserved->second : 0);
+        reservableCash[pair.first].available.store(available, std::memory_order_relaxed);
+    }
+}
+
+bool Portfolio::reserveBuyingPower(const Order& order, double executionPrice, double fee, const Reservation* held) {
+    // Margin is not split per currency; margin-account fills are checked when applied
+    if (order.getType() != OrderType::BUY || isMarginAccount()) {
+        return true;
+    }
+    
+    const Instrument& instrument = getInstrument(order.getSymbol());
+    Money required = instrument.notional(instrument.toTicks(executionPrice), instrument.toLots(order.getQuantity()))
+                   + toMoney(fee);
+    if (held) {
+        // The order may spend what it holds itself
+        required -= held->cash;
+        if (required <= 0) {
+            return true;
+        }
+    }
+    auto it = reservableCash.find(instrument.currency);
+    if (it == reservableCash.end()) {
+        return false;
+    }
+    
+    std::atomic<Money>& available = it->second.available;
+    Money current = available.load(std::memory_order_relaxed);
+    while (current >= required) {
+        if (available.compare_exchange_weak(current, current - required, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double Portfolio::getCash() const {
+    double total = 0.0;
+    for (const auto& pair : cashBalances) {
+        total += toBase(pair.first, pair.second);
+    }
+    return total;
+}
+
+double Portfolio::getCashBalance(const std::string& currency) const {
+    auto it = cashBalances.find(currency);
+    return (it != cashBalances.end()) ? fromMoney(it->second) : 0.0;
 }
 
 bool Portfolio::hasPosition(const std::string& symbol) const {
@@ -87,26 +515,79 @@ double Portfolio::getPositionValue(const std::string& symbol, double currentPric
     return (it != positions.end()) ? it->second.quantity * currentPrice : 0.0;
 }
 
-double Portfolio::getTotalPnL() const {
-    double totalPnL = 0.0;
+double Portfolio::getRealizedPnL() const {
+    double realized = 0.0;
+    for (const auto& pair : closedPnL) {
+        realized += toBase(pair.second.currency, pair.second.realized);
+    }
     for (const auto& pair : positions) {
-        const Position& pos = pair.second;
-        totalPnL += pos.realizedPnL + pos.unrealizedPnL;
+        realized += toBase(pair.second.currency, pair.second.realized);
+    }
+    return realized;
+}
+
+double Portfolio::getRealizedPnL(const std::string& symbol) const {
+    double realized = 0.0;
+    auto closed = closedPnL.find(symbol);
+    if (closed != closedPnL.end()) {
+        realized += toBase(closed->second.currency, closed->second.realized);
+    }
+    auto open = positions.find(symbol);
+    if (open != positions.end()) {
+        realized += toBase(open->second.currency, open->second.realized);
     }
-    return totalPnL;
+    return realized;
+}
+
+double Portfolio::getUnrealizedPnL() const {
+    double unrealized = 0.0;
+    for (const auto& pair : positions) {
+        unrealized += toBase(pair.second.currency, pair.second.unrealized);
+    }
+    return unrealized;
+}
+
+double Portfolio::getTotalPnL() const {
+    return getRealizedPnL() + getUnrealizedPnL() + getDerivativesPnL();
 }
 
 double Portfolio::getPortfolioReturn() const {
-    double initialValue = 100000.0; // Assume default initial value
-    return (totalValue - initialValue) / initialValue * 100.0;
+    if (initialCash <= 0.0) {
+        return 0.0;
+    }
+    return (totalValue - initialCash) / initialCash * 100.0;
+}
+
+void Portfolio::recordEquitySnapshot() {
+    double gross = 0.0;
+    double net = 0.0;
+    for (const auto& pair : positions) {
+        const Position& pos = pair.second;
+        double marketValue = toBase(pos.currency, pos.costBasis + pos.unrealized);
+        gross += std::abs(marketValue);
+        net += marketValue;
+    }
+    gross += std::abs(derivativesValue);
+    net += derivativesValue;
+    analytics.recordEquity(totalValue, gross, net);
 }
 
 void Portfolio::printPortfolioSummary() const {
     std::cout << "\n=== Portfolio Summary ===" << std::endl;
     std::cout << std::fixed << std::setprecision(2);
-    std::cout << "Cash: $" << cash << std::endl;
+    std::cout << "Cash: $" << getCash() << std::endl;
+    if (cashBalances.size() > 1) {
+        for (const auto& pair : cashBalances) {
+            std::cout << "  " << pair.first << ": " << fromMoney(pair.second) << std::endl;
+        }
+    }
     std::cout << "Total Portfolio Value: $" << totalValue << std::endl;
     std::cout << "Total P&L: $" << getTotalPnL() << std::endl;
+    std::cout << "  Realized: $" << getRealizedPnL() << ", Unrealized: $" << getUnrealizedPnL() << std::endl;
+    if (derivativesValue != 0.0 || derivativesCashFlow != 0.0) {
+        std::cout << "  Derivatives: $" << getDerivativesPnL() << " (book value $" << derivativesValue
+                  << ", premiums and variation margin $" << derivativesCashFlow << ")" << std::endl;
+    }
     std::cout << "Portfolio Return: " << getPortfolioReturn() << "%" << std::endl;
     
     if (!positions.empty()) {
@@ -121,12 +602,59 @@ void Portfolio::printPortfolioSummary() const {
     std::cout << "========================\n" << std::endl;
 }
 
+double Portfolio::toBase(const std::string& currency, Money amount) const {
+    return fromMoney(amount) * getFxRate(currency);
+}
+
+void Portfolio::refreshPosition(Position& pos, const Instrument& instrument) {
+    pos.unrealized = instrument.notional(pos.markTicks, pos.lots) - pos.costBasis;
+    pos.quantity = instrument.fromLots(pos.lots);
+    pos.averagePrice = (pos.lots != 0) ? fromMoney(pos.costBasis) / pos.quantity : 0.0;
+    pos.realizedPnL = fromMoney(pos.realized);
+    pos.unrealizedPnL = fromMoney(pos.unrealized);
+}
+
 void Portfolio::updateTotalValue() {
-    totalValue = cash;
+    totalValue = getCash() + derivativesValue;
+    grossExposure = 0.0;
     for (const auto& pair : positions) {
         const Position& pos = pair.second;
-        // For this calculation, we'd need current market prices
-        // This is a simplified version
-        totalValue += pos.quantity * pos.averagePrice + pos.unrealizedPnL;
+        // Market value at the last mark: cost basis plus unrealized PnL
+        double marketValue = toBase(pos.currency, pos.costBasis + pos.unrealized);
+        totalValue += marketValue;
+        grossExposure += std::abs(marketValue);
+    }
+}
+
+Lots Portfolio::closableLots(const Order& order, Lots lots, const Reservation* held) const {
+    auto it = positions.find(order.getSymbol());
+    if (it == positions.end()) {
+        return 0;
+    }
+    Lots position = it->second.lots;
+    bool isBuy = order.getType() == OrderType::BUY;
+    if (position == 0 || (position > 0) == isBuy) {
+        return 0;
+    }
+    
+    // Lots of the position not already promised to other working orders
+    auto reserved = reservedCloseLots.find(order.getSymbol());
+    Lots promised = (reserved != reservedCloseLots.end()) ? reserved->second : 0;
+    if (held) {
+        promised -= held->closeLots;
+    }
+    Lots available = (position < 0 ? -position : position) - promised;
+    return std::max<Lots>(0, std::min(lots, available));
+}
+
+Money Portfolio::initialMarginFor(Money notional) const {
+    return static_cast<Money>(std::llround(static_cast<double>(notional) / marginPolicy.leverage));
+}
+
+double Portfolio::reservedInBase() const {
+    double total = 0.0;
+    for (const auto& pair : reservedCash) {
+        total += toBase(pair.first, pair.second);
     }
+    return total;
 }
@@ -0,0 +1,112 @@
+#include "ResultsWriter.h"
+#include "Portfolio.h"
+#include "Market.h"
+
+namespace {
+const char* sideName(OrderType type) {
+    return type == OrderType::BUY ? "BUY" : "SELL";
+}
+
+const char* executionTypeName(ExecutionType type) {
+    switch (type) {
+        case ExecutionType::MARKET: return "MARKET";
+        case ExecutionType::LIMIT: return "LIMIT";
+        case ExecutionType::STOP: return "STOP";
+        case ExecutionType::STOP_LIMIT: return "STOP_LIMIT";
+        case ExecutionType::TRAILING_STOP: return "TRAILING_STOP";
+    }
+    return "UNKNOWN";
+}
+
+const char* eventName(OrderEvent event) {
+    switch (event) {
+        case OrderEvent::SUBMITTED: return "SUBMITTED";
+        case OrderEvent::TRIGGERED: return "TRIGGERED";
+        case OrderEvent::CANCELLED: return "CANCELLED";
+        case OrderEvent::EXPIRED: return "EXPIRED";
+        case OrderEvent::REJECTED: return "REJECTED";
+    }
+    return "UNKNOWN";
+}
+}
+
+ResultsWriter::ResultsWriter(const std::string& pathPrefix, size_t chunkRows)
+    : fills(pathPrefix + "_fills.tcol",
+            {{"step", ColumnType::INT64}, {"orderId", ColumnType::INT64}, {"symbol", ColumnType::STRING},
+             {"side", ColumnType::STRING}, {"quantity", ColumnType::DOUBLE}, {"price", ColumnType::DOUBLE},
+             {"fee", ColumnType::DOUBLE}, {"liquidity", ColumnType::STRING}, {"strategy", ColumnType::STRING}},
+            chunkRows),
+      orderEvents(pathPrefix + "_orders.tcol",
+                  {{"step", ColumnType::INT64}, {"orderId", ColumnType::INT64}, {"symbol", ColumnType::STRING},
+                   {"event", ColumnType::STRING}, {"side", ColumnType::STRING}, {"type", ColumnType::STRING},
+                   {"quantity", ColumnType::DOUBLE}, {"price", ColumnType::DOUBLE}},
+                  chunkRows),
+      equity(pathPrefix + "_equity.tcol",
+             {{"step", ColumnType::INT64}, {"cash", ColumnType::DOUBLE}, {"totalValue", ColumnType::DOUBLE},
+              {"pnl", ColumnType::DOUBLE}},
+             chunkRows),
+      prices(pathPrefix + "_prices.tcol",
+             {{"step", ColumnType::INT64}, {"symbol", ColumnType::STRING}, {"price", ColumnType::DOUBLE},
+              {"return", ColumnType::DOUBLE}},
+             chunkRows) {}
+
+bool ResultsWriter::isOpen() const {
+    return fills.isOpen() && orderEvents.isOpen() && equity.isOpen() && prices.isOpen();
+}
+
+size_t ResultsWriter::getPendingChunks() const {
+    return fills.getPendingChunks() + orderEvents.getPendingChunks() + equity.getPendingChunks() +
+           prices.getPendingChunks();
+}
+
+void ResultsWriter::recordFill(long step, const Order& order, double price, double fee, LiquidityFlag liquidity) {
+    fills.appendInt(0, step);
+    fills.appendInt(1, order.getOrderId());
+    fills.appendString(2, order.getSymbol());
+    fills.appendString(3, sideName(order.getType()));
+    fills.appendDouble(4, order.getQuantity());
+    fills.appendDouble(5, price);
+    fills.appendDouble(6, fee);
+    fills.appendString(7, liquidity == LiquidityFlag::MAKER ? "MAKER" : "TAKER");
+    fills.appendString(8, order.getTag());
+    fills.endRow();
+}
+
+void ResultsWriter::recordOrderEvent(long step, const Order& order, OrderEvent event) {
+    orderEvents.appendInt(0, step);
+    orderEvents.appendInt(1, order.getOrderId());
+    orderEvents.appendString(2, order.getSymbol());
+    orderEvents.appendString(3, eventName(event));
+    orderEvents.appendString(4, sideName(order.getType()));
+    orderEvents.appendString(5, executionTypeName(order.getExecutionType()));
+    orderEvents.appendDouble(6, order.getQuantity());
+    orderEvents.appendDouble(7, order.getPrice());
+    orderEvents.endRow();
+}
+
+void ResultsWriter::recordEquity(long step, const Portfolio& portfolio) {
+    equity.appendInt(0, step);
+    equity.appendDouble(1, portfolio.getCash());
+    equity.appendDouble(2, portfolio.getTotalValue());
+    equity.appendDouble(3, portfolio.getTotalValue() - portfolio.getInitialCash());
+    equity.endRow();
+}
+
+void ResultsWriter::recordPrices(long step, const Market& market) {
+    const MarketSnapshot& snapshot = market.getSnapshot();
+    const std::vector<std::string>& symbols = market.getSymbolsByIndex();
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        prices.appendInt(0, step);
+        prices.appendString(1, symbols[i]);
+        prices.appendDouble(2, snapshot.prices[i]);
+        prices.appendDouble(3, snapshot.returns[i]);
+        prices.endRow();
+    }
+}
+
+void ResultsWriter::close() {
+    fills.close();
+    orderEvents.close();
+    equity.close();
+    prices.close();
+}
@@ -0,0 +1,166 @@
+#include "RollingStatistics.h"
+#include <algorithm>
+#include <cmath>
+
+RollingStatistics::RollingStatistics(size_t windowLength)
+    : window(std::max<size_t>(1, windowLength)),
+      emaAlpha(2.0 / (static_cast<double>(std::max<size_t>(1, windowLength)) + 1.0)) {}
+
+size_t RollingStatistics::addSymbol() {
+    size_t index = sequence.size();
+
+    priceRing.resize(priceRing.size() + window, 0.0);
+    volumeRing.resize(volumeRing.size() + window, 0.0);
+    returnRing.resize(returnRing.size() + window, 0.0);
+    minQueue.resize(minQueue.size() + window, 0);
+    maxQueue.resize(maxQueue.size() + window, 0);
+
+    minHead.push_back(0);
+    minSize.push_back(0);
+    maxHead.push_back(0);
+    maxSize.push_back(0);
+
+    sequence.push_back(0);
+    returnCount.push_back(0);
+    lastPrice.push_back(0.0);
+    priceSum.push_back(0.0);
+    volumeSum.push_back(0.0);
+    notionalSum.push_back(0.0);
+    returnSum.push_back(0.0);
+    returnSumSq.push_back(0.0);
+
+    sma.push_back(0.0);
+    ema.push_back(0.0);
+    variance.push_back(0.0);
+    minimum.push_back(0.0);
+    maximum.push_back(0.0);
+    vwap.push_back(0.0);
+
+    return index;
+}
+
+void RollingStatistics::update(size_t index, double price, double volume) {
+    if (index >= sequence.size()) {
+        return;
+    }
+
+    uint64_t seq = sequence[index];
+    size_t slot = index * window + seq % window;
+
+    // Slide the price window: evict the oldest point once the window is full
+    if (seq >= window) {
+        priceSum[index] -= priceRing[slot];
+        volumeSum[index] -= volumeRing[slot];
+        notionalSum[index] -= priceRing[slot] * volumeRing[slot];
+    }
+    priceRing[slot] = price;
+    volumeRing[slot] = volume;
+    priceSum[index] += price;
+    volumeSum[index] += volume;
+    notionalSum[index] += price * volume;
+
+    // Slide the log-return window
+    if (seq > 0 && lastPrice[index] > 0.0 && price > 0.0) {
+        double logReturn = std::log(price / lastPrice[index]);
+        uint64_t count = returnCount[index];
+        size_t returnSlot = index * window + count % window;
+        if (count >= window) {
+            double old = returnRing[returnSlot];
+            returnSum[index] -= old;
+            returnSumSq[index] -= old * old;
+        }
+        returnRing[returnSlot] = logReturn;
+        returnSum[index] += logReturn;
+        returnSumSq[index] += logReturn * logReturn;
+        returnCount[index] = count + 1;
+    }
+    lastPrice[index] = price;
+    sequence[index] = seq + 1;
+
+    pushExtreme(minQueue, minHead, minSize, index, seq, price, true);
+    pushExtreme(maxQueue, maxHead, maxSize, index, seq, price, false);
+
+    // Periodically rebuild the running sums so floating-point drift cannot accumulate
+    if ((seq + 1) % window == 0) {
+        recomputeSums(index);
+    }
+
+    // Publish
+    double n = static_cast<double>(std::min<uint64_t>(seq + 1, window));
+    sma[index] = priceSum[index] / n;
+    ema[index] = (seq == 0) ? price : ema[index] + emaAlpha * (price - ema[index]);
+
+    uint64_t returnsInWindow = std::min<uint64_t>(returnCount[index], window);
+    if (returnsInWindow > 1) {
+        double rn = static_cast<double>(returnsInWindow);
+        double var = (returnSumSq[index] - returnSum[index] * returnSum[index] / rn) / (rn - 1.0);
+        variance[index] = std::max(0.0, var);
+    } else {
+        variance[index] = 0.0;
+    }
+
+    minimum[index] = priceAt(index, minQueue[index * window + minHead[index]]);
+    maximum[index] = priceAt(index, maxQueue[index * window + maxHead[index]]);
+    vwap[index] = (volumeSum[index] > 0.0) ? notionalSum[index] / volumeSum[index] : sma[index];
+}
+
+size_t RollingStatistics::getCount(size_t index) const {
+    return static_cast<size_t>(std::min<uint64_t>(sequence[index], window));
+}
+
+double RollingStatistics::getRealizedVolatility(size_t index, double periodsPerYear) const {
+    return std::sqrt(variance[index] * periodsPerYear);
+}
+
+void RollingStatistics::pushExtreme(std::vector<uint64_t>& queue, std::vector<size_t>& head,
+                                    std::vector<size_t>& size, size_t index, uint64_t seq,
+                                    double price, bool keepMin) {
+    size_t base = index * window;
+    size_t& front = head[index];
+    size_t& count = size[index];
+
+    // Drop entries that fell out of the window
+    while (count > 0 && queue[base + front] + window <= seq) {
+        front = (front + 1) % window;
+        --count;
+    }
+
+    // Drop entries dominated by the new price
+    while (count > 0) {
+        size_t back = (front + count - 1) % window;
+        double backPrice = priceAt(index, queue[base + back]);
+        if (keepMin ? backPrice >= price : backPrice <= price) {
+            --count;
+        } else {
+            break;
+        }
+    }
+
+    queue[base + (front + count) % window] = seq;
+    ++count;
+}
+
+void RollingStatistics::recomputeSums(size_t index) {
+    size_t base = index * window;
+    size_t prices = static_cast<size_t>(std::min<uint64_t>(sequence[index], window));
+    size_t returns = static_cast<size_t>(std::min<uint64_t>(returnCount[index], window));
+
+    double pSum = 0.0, vSum = 0.0, nSum = 0.0;
+    for (size_t k = 0; k < prices; ++k) {
+        pSum += priceRing[base + k];
+        vSum += volumeRing[base + k];
+        nSum += priceRing[base + k] * volumeRing[base + k];
+    }
+
+    double rSum = 0.0, rSumSq = 0.0;
+    for (size_t k = 0; k < returns; ++k) {
+        rSum += returnRing[base + k];
+        rSumSq += returnRing[base + k] * returnRing[base + k];
+    }
+
+    priceSum[index] = pSum;
+    volumeSum[index] = vSum;
+    notionalSum[index] = nSum;
+    returnSum[index] = rSum;
+    returnSumSq[index] = rSumSq;
+}
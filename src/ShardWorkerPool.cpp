@@ -0,0 +1,100 @@
+#include "ShardWorkerPool.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ShardWorkerPool::ShardWorkerPool(size_t workerCount, bool pinThreads)
+    : task(nullptr), generation(0), remaining(0), stopping(false)
+{
+    workerCount = std::max<size_t>(1, workerCount);
+    threads.reserve(workerCount);
+    for (size_t shard = 0; shard < workerCount; ++shard)
+    {
+        threads.emplace_back(&ShardWorkerPool::workerLoop, this, shard, pinThreads, shard);
+    }
+}
+
+ShardWorkerPool::ShardWorkerPool(const std::vector<size_t> &cpus)
+    : task(nullptr), generation(0), remaining(0), stopping(false)
+{
+    threads.reserve(cpus.size());
+    for (size_t shard = 0; shard < cpus.size(); ++shard)
+    {
+        threads.emplace_back(&ShardWorkerPool::workerLoop, this, shard, true, cpus[shard]);
+    }
+}
+
+ShardWorkerPool::~ShardWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ShardWorkerPool::run(const std::function<void(size_t)> &shardTask)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &shardTask;
+    remaining = threads.size();
+    ++generation;
+    startCondition.notify_all();
+    doneCondition.wait(lock, [this] { return remaining == 0; });
+    task = nullptr;
+}
+
+bool ShardWorkerPool::pinCurrentThread(size_t core)
+{
+#ifdef __linux__
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(static_cast<int>(core % cores), &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+void ShardWorkerPool::workerLoop(size_t shard, bool pin, size_t cpu)
+{
+    if (pin)
+    {
+        pinCurrentThread(cpu);
+    }
+
+    uint64_t seenGeneration = 0;
+    while (true)
+    {
+        const std::function<void(size_t)> *current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [this, seenGeneration] { return stopping || generation != seenGeneration; });
+            if (stopping)
+            {
+                return;
+            }
+            seenGeneration = generation;
+            current = task;
+        }
+
+        (*current)(shard);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0)
+            {
+                doneCondition.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#include "SimulationBatch.h"
+
+SimulationBatch::SimulationBatch(const BatchConfig &config)
+    : arenaChunkBytes(config.arenaChunkBytes), workerCpus(chooseCpus(config)), pool(workerCpus),
+      counters(workerCpus.size()), nextJob(0)
+{
+    const NumaTopology &topology = NumaTopology::get();
+    for (size_t cpu : workerCpus)
+    {
+        workerNodes.push_back(topology.getNodeOfCpu(cpu));
+    }
+}
+
+std::vector<size_t> SimulationBatch::chooseCpus(const BatchConfig &config)
+{
+    if (!config.cpus.empty())
+    {
+        return config.cpus;
+    }
+    const NumaTopology &topology = NumaTopology::get();
+    size_t workers = config.workers ? config.workers : topology.getCpuCount();
+    return topology.selectCpus(workers, config.spreadNodes);
+}
+
+void SimulationBatch::run(size_t jobCount, const std::function<void(BatchJob &)> &job)
+{
+    nextJob.store(0, std::memory_order_relaxed);
+    std::function<void(size_t)> task = [&](size_t worker) {
+        size_t node = workerNodes[worker];
+        while (true)
+        {
+            size_t index = nextJob.fetch_add(1, std::memory_order_relaxed);
+            if (index >= jobCount)
+            {
+                return;
+            }
+
+            // Created (and destroyed) on the worker, so its pages are local
+            SimulationArena arena(node, arenaChunkBytes);
+            BatchJob context{index, worker, node, arena};
+            job(context);
+            counters.add(worker, JOBS);
+        }
+    };
+    pool.run(task);
+}
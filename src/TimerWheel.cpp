@@ -0,0 +1,41 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(size_t slotCount)
+    : slots(std::max<size_t>(1, slotCount)), scheduled(0)
+{
+    // Give every slot some room up front so the first lap of the wheel does
+    // not allocate from the tick loop
+    for (std::vector<Timer> &slot : slots)
+    {
+        slot.reserve(INITIAL_SLOT_CAPACITY);
+    }
+}
+
+void TimerWheel::schedule(int id, long expiryStep)
+{
+    size_t slot = static_cast<size_t>(expiryStep < 0 ? 0 : expiryStep) % slots.size();
+    slots[slot].push_back({id, expiryStep});
+    ++scheduled;
+}
+
+void TimerWheel::advance(long step, std::vector<int> &expired)
+{
+    std::vector<Timer> &bucket = slots[static_cast<size_t>(step < 0 ? 0 : step) % slots.size()];
+
+    // Timers for later laps of the wheel stay in the bucket
+    size_t kept = 0;
+    for (size_t i = 0; i < bucket.size(); ++i)
+    {
+        if (bucket[i].expiryStep <= step)
+        {
+            expired.push_back(bucket[i].id);
+            --scheduled;
+        }
+        else
+        {
+            bucket[kept++] = bucket[i];
+        }
+    }
+    bucket.resize(kept);
+}
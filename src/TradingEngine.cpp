@@ -1,88 +1,198 @@
 #include "TradingEngine.h"
+#include "AllocationTracker.h"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <limits>
+#include <functional>
+#include <chrono>
 
-TradingEngine::TradingEngine(Market &mkt, Portfolio &port, double txnCost)
-    : market(mkt), portfolio(port), transactionCost(txnCost), enableLogging(true) {}
+TradingEngine::TradingEngine(Market &mkt, Portfolio &port, double txnCost, std::pmr::memory_resource *memoryResource)
+    : market(mkt), portfolio(port), bookMemory(memoryResource), books(memoryResource), indexPool(memoryResource),
+      workingOrders(&indexPool), currentStep(0), keepExecutedOrders(true),
+      executedCount(0), buyCount(0), sellCount(0), executedNotional(0.0), resultsWriter(nullptr), journal(nullptr), derivatives(nullptr), metrics(nullptr), feeModel(txnCost),
+      enableLogging(true), latencyEnabled(false), deliveringMessages(false), maxProcessingJitter(0),
+      latencyRandom(42), hotPathAllocations(0), allocatingSteps(0), marginCallActive(false), ordersReceived(0), orderEventCounts{},
+      totalFees(0.0), shardedBookCount(0) {}
 
-bool TradingEngine::submitOrder(const Order &order)
+bool TradingEngine::submitOrder(const Order &submitted)
 {
+    if (journal && !deliveringMessages)
+    {
+        journal->recordSubmit(activeStrategy, market.getQuoteDelay(), submitted);
+    }
+    if (!deliveringMessages)
+    {
+        ++ordersReceived;
+    }
+
+    Order order = submitted;
+    if (order.getTag().empty())
+    {
+        order.setTag(activeStrategy);
+    }
+
+    // With a latency model the order is only sent now and handled on arrival
+    if (latencyEnabled && !deliveringMessages)
+    {
+        sendMessage(LatencyQueue::Kind::SUBMIT, order.getOrderId(), &order);
+        return true;
+    }
+
+    // Orders without a limit price are checked against a reference price
+    ExecutionType executionType = order.getExecutionType();
+    if (order.getPrice() <= 0)
+    {
+        if (executionType == ExecutionType::MARKET || executionType == ExecutionType::TRAILING_STOP)
+        {
+            order.setPrice(market.getCurrentPrice(order.getSymbol()));
+        }
+        else if (executionType == ExecutionType::STOP)
+        {
+            order.setPrice(order.getStopPrice());
+        }
+    }
+
     if (!validateOrder(order))
     {
+        recordOrderEvent(order, OrderEvent::REJECTED);
         if (enableLogging)
         {
-            std::cout << "Order validation failed: " << order.toString() << std::endl;
+            std::cout << "Order validation failed: " << describe(order) << std::endl;
         }
         return false;
     }
 
-    pendingOrders.push(order);
+    // Market, IOC and FOK orders never rest. Fills are all-or-nothing, so IOC
+    // and FOK behave identically here.
+    TimeInForce tif = order.getTimeInForce();
+    if (executionType == ExecutionType::MARKET || tif == TimeInForce::IOC || tif == TimeInForce::FOK)
+    {
+        if (tryExecuteOrder(order, LiquidityFlag::TAKER))
+        {
+            return true;
+        }
+        order.setStatus(OrderStatus::CANCELLED);
+        recordOrderEvent(order, OrderEvent::CANCELLED);
+        if (enableLogging)
+        {
+            std::cout << "Order not immediately executable, cancelled: " << describe(order) << std::endl;
+        }
+        return false;
+    }
+
+    addWorkingOrder(order);
+    recordOrderEvent(order, OrderEvent::SUBMITTED);
     if (enableLogging)
     {
-        std::cout << "Order submitted: " << order.toString() << std::endl;
+        std::cout << "Order submitted: " << describe(order) << std::endl;
     }
     return true;
 }
 
 void TradingEngine::processOrders()
 {
-    std::queue<Order> failedOrders;
+    if (journal)
+    {
+        journal->recordProcess();
+    }
 
-    while (!pendingOrders.empty())
+    if (!inFlight.empty())
     {
-        Order order = pendingOrders.front();
-        pendingOrders.pop();
+        deliverMessages();
+    }
+
+    if (workerPool)
+    {
+        processOrdersSharded();
+        return;
+    }
+
+    ++currentStep;
+    expireOrders();
+    checkMargin();
 
-        if (tryExecuteOrder(order))
+    for (auto &pair : books)
+    {
+        OrderBook &book = pair.second;
+        if (book.empty())
         {
-            executedOrders.push_back(order);
+            continue;
         }
-        else
+
+        double price = market.getCurrentPrice(pair.first);
+        if (book.hasTriggers())
         {
-            // Order couldn't be executed, put it back in queue
-            failedOrders.push(order);
+            triggeredScratch.clear();
+            book.collectTriggered(price, triggeredScratch);
+            for (Order &order : triggeredScratch)
+            {
+                activateTriggeredOrder(book, order);
+            }
         }
-    }
 
-    // Put failed orders back in the queue
-    pendingOrders = failedOrders;
+        // One price lookup per book, not per resting order
+        book.matchResting([&](Order &order) {
+            if (!isMarketable(order, price) || !applyFill(order, price, LiquidityFlag::MAKER))
+            {
+                return false;
+            }
+            removeWorkingOrder(order);
+            return true;
+        });
+    }
 }
 
 void TradingEngine::cancelOrder(int orderId)
 {
-    std::queue<Order> remainingOrders;
-    bool orderFound = false;
+    if (journal && !deliveringMessages)
+    {
+        journal->recordCancel(activeStrategy, market.getQuoteDelay(), orderId);
+    }
 
-    while (!pendingOrders.empty())
+    if (latencyEnabled && !deliveringMessages)
     {
-        Order order = pendingOrders.front();
-        pendingOrders.pop();
+        sendMessage(LatencyQueue::Kind::CANCEL, orderId, nullptr);
+        return;
+    }
 
-        if (order.getOrderId() == orderId)
-        {
-            orderFound = true;
-            if (enableLogging)
-            {
-                std::cout << "Order cancelled: " << order.toString() << std::endl;
-            }
-        }
-        else
+    auto it = workingOrders.find(orderId);
+    if (it == workingOrders.end())
+    {
+        if (enableLogging)
         {
-            remainingOrders.push(order);
+            std::cout << "Order #" << orderId << " not found in pending orders" << std::endl;
         }
+        return;
     }
 
-    pendingOrders = remainingOrders;
+    std::optional<Order> order = it->second.book->remove(orderId);
+    if (order)
+    {
+        portfolio.releaseOrder(*order, it->second.reservation);
+    }
+    workingOrders.erase(it);
+    if (!order)
+    {
+        return;
+    }
 
-    if (!orderFound && enableLogging)
+    order->setStatus(OrderStatus::CANCELLED);
+    recordOrderEvent(*order, OrderEvent::CANCELLED);
+    if (enableLogging)
     {
-        std::cout << "Order #" << orderId << " not found in pending orders" << std::endl;
+        std::cout << "Order cancelled: " << describe(*order) << std::endl;
     }
 }
 
 void TradingEngine::executeMarketOrder(const std::string &symbol, OrderType type, double quantity)
 {
+    if (journal)
+    {
+        journal->recordMarketOrder(activeStrategy, market.getQuoteDelay(), Order::getNextOrderId(), symbol, type, quantity);
+    }
+    ++ordersReceived;
+
     if (!market.hasSymbol(symbol))
     {
         if (enableLogging)
@@ -94,41 +204,117 @@ void TradingEngine::executeMarketOrder(const std::string &symbol, OrderType type
 
     double currentPrice = market.getCurrentPrice(symbol);
     Order marketOrder(symbol, type, quantity, currentPrice);
+    marketOrder.setExecutionType(ExecutionType::MARKET);
+    marketOrder.setTag(activeStrategy);
+
+    if (latencyEnabled && !deliveringMessages)
+    {
+        sendMessage(LatencyQueue::Kind::SUBMIT, marketOrder.getOrderId(), &marketOrder);
+        return;
+    }
 
     if (validateOrder(marketOrder))
     {
-        if (tryExecuteOrder(marketOrder))
-        {
-            executedOrders.push_back(marketOrder);
-        }
+        tryExecuteOrder(marketOrder, LiquidityFlag::TAKER);
+    }
+    else
+    {
+        recordOrderEvent(marketOrder, OrderEvent::REJECTED);
     }
 }
 
 void TradingEngine::executeLimitOrder(const std::string &symbol, OrderType type, double quantity, double price)
 {
     Order limitOrder(symbol, type, quantity, price);
+    limitOrder.setTag(activeStrategy);
     submitOrder(limitOrder);
 }
 
+void TradingEngine::executeStopOrder(const std::string &symbol, OrderType type, double quantity, double stopPrice)
+{
+    Order stopOrder(symbol, type, quantity, stopPrice);
+    stopOrder.setExecutionType(ExecutionType::STOP);
+    stopOrder.setStopPrice(stopPrice);
+    stopOrder.setTag(activeStrategy);
+    submitOrder(stopOrder);
+}
+
+void TradingEngine::executeStopLimitOrder(const std::string &symbol, OrderType type, double quantity,
+                                          double stopPrice, double limitPrice)
+{
+    Order stopLimitOrder(symbol, type, quantity, limitPrice);
+    stopLimitOrder.setExecutionType(ExecutionType::STOP_LIMIT);
+    stopLimitOrder.setStopPrice(stopPrice);
+    stopLimitOrder.setTag(activeStrategy);
+    submitOrder(stopLimitOrder);
+}
+
+void TradingEngine::executeTrailingStopOrder(const std::string &symbol, OrderType type, double quantity,
+                                             double trailAmount)
+{
+    Order trailingOrder(symbol, type, quantity, market.getCurrentPrice(symbol));
+    trailingOrder.setExecutionType(ExecutionType::TRAILING_STOP);
+    trailingOrder.setTrailAmount(trailAmount);
+    trailingOrder.setTag(activeStrategy);
+    submitOrder(trailingOrder);
+}
+
 void TradingEngine::runSimulation(int steps)
 {
     std::cout << "\n=== Running Trading Simulation for " << steps << " steps ===" << std::endl;
 
+    for (IStrategy *strategy : strategies)
+    {
+        strategy->onSimulationStart();
+    }
+
     for (int step = 0; step < steps; ++step)
     {
-        // Update market prices
+        AllocationTracker::Scope stepAllocations;
+        std::chrono::steady_clock::time_point stepStart;
+        if (metrics)
+        {
+            stepStart = std::chrono::steady_clock::now();
+        }
+
+        // Update market prices and portfolio values
         market.updatePrices();
+        markToMarket();
 
-        // Update portfolio values with current market prices
-        for (const std::string &symbol : market.getAvailableSymbols())
+        // Let strategies react to the new prices
+        if (!strategies.empty())
         {
-            double currentPrice = market.getCurrentPrice(symbol);
-            portfolio.updatePositionValue(symbol, currentPrice);
+            savedStrategy = activeStrategy;
+            for (size_t i = 0; i < strategies.size(); ++i)
+            {
+                activeStrategy = strategyNames[i];
+                if (latencyEnabled)
+                {
+                    market.setQuoteDelay(static_cast<size_t>(std::max(0L, latencyFor(activeStrategy).marketDataDelay)));
+                }
+                strategies[i]->onTick(market, portfolio, *this, step);
+            }
+            market.setQuoteDelay(0);
+            activeStrategy = savedStrategy;
         }
 
         // Process pending orders
         processOrders();
 
+        // The first step sizes the reusable buffers; later ones should not allocate
+        if (step > 0 && stepAllocations.allocations() > 0)
+        {
+            hotPathAllocations += stepAllocations.allocations();
+            ++allocatingSteps;
+        }
+
+        if (metrics)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - stepStart;
+            metrics->observeStepDuration(elapsed.count());
+            publishMetrics();
+        }
+
         // Print status every 10 steps
         if ((step + 1) % 10 == 0)
         {
@@ -137,40 +323,92 @@ void TradingEngine::runSimulation(int steps)
         }
     }
 
+    for (IStrategy *strategy : strategies)
+    {
+        strategy->onSimulationStop();
+    }
+
     std::cout << "\n=== Simulation Complete ===" << std::endl;
     portfolio.printPortfolioSummary();
+    portfolio.getAnalytics().printSummary();
     printTradingStats();
 }
 
-void TradingEngine::printTradingStats() const
+void TradingEngine::markToMarket()
 {
-    std::cout << "\n=== Trading Statistics ===" << std::endl;
-    std::cout << "Total Executed Orders: " << executedOrders.size() << std::endl;
-    std::cout << "Pending Orders: " << pendingOrders.size() << std::endl;
+    if (journal)
+    {
+        journal->recordTick(currentStep, market.getSnapshot());
+    }
 
-    if (!executedOrders.empty())
+    for (const std::string &symbol : market.getAvailableSymbols())
+    {
+        double currentPrice = market.getCurrentPrice(symbol);
+        portfolio.updatePositionValue(symbol, currentPrice);
+    }
+    portfolio.accrueBorrowCosts(1.0 / 252.0);
+    if (derivatives)
+    {
+        derivatives->revalue(market);
+        portfolio.settleDerivatives(derivatives->takeCashFlow(), derivatives->getTotals().value);
+    }
+    portfolio.recordEquitySnapshot();
+    if (resultsWriter)
     {
-        int buyOrders = 0, sellOrders = 0;
-        double totalVolume = 0.0;
+        resultsWriter->recordEquity(currentStep, portfolio);
+        resultsWriter->recordPrices(currentStep, market);
+    }
+}
 
-        for (const auto &order : executedOrders)
-        {
-            if (order.getType() == OrderType::BUY)
-            {
-                buyOrders++;
-            }
-            else
-            {
-                sellOrders++;
-            }
-            totalVolume += order.getQuantity() * order.getPrice();
-        }
+void TradingEngine::publishMetrics()
+{
+    if (!metrics)
+    {
+        return;
+    }
+
+    EngineMetrics snapshot;
+    snapshot.steps = static_cast<uint64_t>(currentStep);
+    snapshot.ordersReceived = ordersReceived;
+    std::copy(std::begin(orderEventCounts), std::end(orderEventCounts), std::begin(snapshot.orderEvents));
+    snapshot.fills = executedCount;
+    snapshot.hotPathAllocations = hotPathAllocations;
+    snapshot.restingOrders = workingOrders.size();
+    snapshot.inFlightMessages = inFlight.size();
+    snapshot.pendingResultChunks = resultsWriter ? resultsWriter->getPendingChunks() : 0;
+    snapshot.equity = portfolio.getTotalValue();
+    snapshot.cash = portfolio.getCash();
+    snapshot.totalFees = totalFees;
+    metrics->publish(snapshot);
+}
+
+void TradingEngine::setJournal(InputJournal *inputJournal)
+{
+    journal = inputJournal;
+    if (journal)
+    {
+        journal->recordSymbols(market);
+    }
+}
+
+void TradingEngine::printTradingStats() const
+{
+    std::cout << "\n=== Trading Statistics ===" << std::endl;
+    std::cout << "Total Executed Orders: " << executedCount << std::endl;
+    std::cout << "Pending Orders: " << workingOrders.size() << std::endl;
 
+    if (executedCount > 0)
+    {
         std::cout << std::fixed << std::setprecision(2);
-        std::cout << "Buy Orders: " << buyOrders << std::endl;
-        std::cout << "Sell Orders: " << sellOrders << std::endl;
-        std::cout << "Total Trading Volume: $" << totalVolume << std::endl;
-        std::cout << "Average Order Value: $" << totalVolume / executedOrders.size() << std::endl;
+        std::cout << "Buy Orders: " << buyCount << std::endl;
+        std::cout << "Sell Orders: " << sellCount << std::endl;
+        std::cout << "Total Trading Volume: $" << executedNotional << std::endl;
+        std::cout << "Average Order Value: $" << executedNotional / executedCount << std::endl;
+        std::cout << "Total Fees: $" << totalFees << std::endl;
+    }
+    if (AllocationTracker::isEnabled())
+    {
+        std::cout << "Hot-Path Allocations: " << hotPathAllocations << " in " << allocatingSteps << " steps" << std::endl;
     }
     std::cout << "==========================\n"
               << std::endl;
@@ -184,20 +422,45 @@ bool TradingEngine::validateOrder(const Order &order) const
         return false;
     }
 
-    // Check order quantity is positive
-    if (order.getQuantity() <= 0)
+    // Check order quantity is positive and a whole number of lots
+    if (order.getQuantity() <= 0 || !portfolio.getInstrument(order.getSymbol()).isWholeLots(order.getQuantity()))
     {
         return false;
     }
 
-    // Check order price is positive
+    // Check order price is positive (reference price for market and stop orders)
     if (order.getPrice() <= 0)
     {
         return false;
     }
 
-    // Check if portfolio can afford the order
-    if (!portfolio.canAffordOrder(order))
+    // Check trigger parameters; triggers must be allowed to rest
+    ExecutionType executionType = order.getExecutionType();
+    bool isStop = executionType == ExecutionType::STOP || executionType == ExecutionType::STOP_LIMIT;
+    if (isStop && order.getStopPrice() <= 0)
+    {
+        return false;
+    }
+    if (executionType == ExecutionType::TRAILING_STOP && order.getTrailAmount() <= 0)
+    {
+        return false;
+    }
+    bool immediate = order.getTimeInForce() == TimeInForce::IOC || order.getTimeInForce() == TimeInForce::FOK;
+    if ((isStop || executionType == ExecutionType::TRAILING_STOP) && immediate)
+    {
+        return false;
+    }
+
+    // GTT orders expire in a later processOrders step; an expiry that has
+    // already been reached (or was never set) could not be scheduled
+    if (order.getTimeInForce() == TimeInForce::GTT && order.getExpiryStep() <= currentStep)
+    {
+        return false;
+    }
+
+    // Check if portfolio can afford the order, fees included
+    double fee = feeModel.computeFee(order.getQuantity(), order.getPrice(), LiquidityFlag::TAKER);
+    if (!portfolio.canAffordOrder(order, fee))
     {
         return false;
     }
@@ -205,38 +468,556 @@ bool TradingEngine::validateOrder(const Order &order) const
     return true;
 }
 
-bool TradingEngine::tryExecuteOrder(Order &order)
+bool TradingEngine::tryExecuteOrder(Order &order, LiquidityFlag liquidity)
 {
     double currentPrice = market.getCurrentPrice(order.getSymbol());
-    bool canExecute = false;
+    return isMarketable(order, currentPrice) && applyFill(order, currentPrice, liquidity);
+}
 
+bool TradingEngine::isMarketable(const Order &order, double price) const
+{
+    if (order.getExecutionType() == ExecutionType::MARKET)
+    {
+        return true;
+    }
     if (order.getType() == OrderType::BUY)
     {
         // For buy orders, execute if current price is at or below limit price
-        canExecute = currentPrice <= order.getPrice();
+        return price <= order.getPrice();
+    }
+    // For sell orders, execute if current price is at or above limit price
+    return price >= order.getPrice();
+}
+
+bool TradingEngine::applyFill(Order &order, double price, LiquidityFlag liquidity)
+{
+    // A working order may spend the buying power it holds
+    double fee = feeModel.computeFee(order.getQuantity(), price, liquidity);
+    auto working = workingOrders.find(order.getOrderId());
+    Reservation *held = (working != workingOrders.end()) ? &working->second.reservation : nullptr;
+    // Nothing is recorded, and the reservation stays, unless the portfolio
+    // takes the fill at this price
+    if (!portfolio.executeOrder(order, price, fee, held))
+    {
+        return false;
+    }
+    if (held)
+    {
+        portfolio.releaseOrder(order, *held);
+        *held = Reservation();
+    }
+
+    order.fillOrder(order.getQuantity());
+    order.setStatus(OrderStatus::FILLED);
+
+    feeModel.recordVolume(order.getQuantity());
+    totalFees += fee;
+    feesBySymbol[order.getSymbol()] += fee;
+    feesByStrategy[order.getTag()] += fee;
+
+    ++executedCount;
+    ++(order.getType() == OrderType::BUY ? buyCount : sellCount);
+    executedNotional += order.getQuantity() * price;
+    if (keepExecutedOrders)
+    {
+        executedOrders.push_back(order);
+    }
+    if (resultsWriter)
+    {
+        resultsWriter->recordFill(currentStep, order, price, fee, liquidity);
+    }
+
+    for (size_t i = 0; i < strategies.size(); ++i)
+    {
+        if (strategyNames[i] == order.getTag())
+        {
+            strategies[i]->onOrderExecuted(order);
+        }
+    }
+
+    if (enableLogging)
+    {
+        logOrderExecution(order, price);
+    }
+    return true;
+}
+
+void TradingEngine::recordOrderEvent(const Order &order, OrderEvent event)
+{
+    ++orderEventCounts[static_cast<size_t>(event)];
+    if (resultsWriter)
+    {
+        resultsWriter->recordOrderEvent(currentStep, order, event);
+    }
+}
+
+void TradingEngine::addStrategy(IStrategy *strategy)
+{
+    if (strategy)
+    {
+        strategies.push_back(strategy);
+        strategyNames.push_back(strategy->name());
+    }
+}
+
+void TradingEngine::setLatency(const LatencyProfile &profile)
+{
+    defaultLatency = profile;
+    latencyEnabled = true;
+}
+
+void TradingEngine::setStrategyLatency(const std::string &strategy, const LatencyProfile &profile)
+{
+    strategyLatency[strategy] = profile;
+    latencyEnabled = true;
+}
+
+void TradingEngine::setProcessingJitter(long maxJitterSteps, unsigned int seed)
+{
+    maxProcessingJitter = std::max(0L, maxJitterSteps);
+    latencyRandom.seed(seed);
+    latencyEnabled = true;
+}
+
+const LatencyProfile &TradingEngine::latencyFor(const std::string &strategy) const
+{
+    auto it = strategyLatency.find(strategy);
+    return (it != strategyLatency.end()) ? it->second : defaultLatency;
+}
+
+void TradingEngine::sendMessage(LatencyQueue::Kind kind, int orderId, const Order *order)
+{
+    long delay = std::max(0L, latencyFor(activeStrategy).orderEntryDelay);
+    if (maxProcessingJitter > 0)
+    {
+        delay += std::uniform_int_distribution<long>(0, maxProcessingJitter)(latencyRandom);
+    }
+
+    // Jitter may delay a message but never reorders a strategy's messages,
+    // so a cancel cannot overtake the submit it refers to
+    long arrival = currentStep + delay;
+    auto last = lastArrival.find(activeStrategy);
+    if (last == lastArrival.end())
+    {
+        lastArrival.emplace(activeStrategy, arrival);
     }
     else
     {
-        // For sell orders, execute if current price is at or above limit price
-        canExecute = currentPrice >= order.getPrice();
+        arrival = std::max(arrival, last->second);
+        last->second = arrival;
     }
+    inFlight.send(kind, orderId, order, currentStep, arrival);
+}
 
-    if (canExecute)
+void TradingEngine::deliverMessages()
+{
+    // Arrivals are handled in send order, before this step's matching
+    inFlight.collectArrived(currentStep, arrivedMessages);
+    deliveringMessages = true;
+    for (LatencyQueue::Message &message : arrivedMessages)
     {
-        // Execute the order
-        order.fillOrder(order.getQuantity());
-        order.setStatus(OrderStatus::FILLED);
-        portfolio.executeOrder(order, currentPrice);
+        if (message.kind == LatencyQueue::Kind::CANCEL)
+        {
+            cancelOrder(message.orderId);
+        }
+        else if (message.order)
+        {
+            submitOrder(*message.order);
+        }
+    }
+    deliveringMessages = false;
+}
 
+void TradingEngine::enableSharding(size_t shardCount, bool pinThreads)
+{
+    workerPool.reset();
+    shards.clear();
+    if (shardCount > 1)
+    {
+        workerPool.reset(new ShardWorkerPool(shardCount, pinThreads));
+        shards.resize(shardCount);
+        rebuildShards();
+    }
+}
+
+void TradingEngine::rebuildShards()
+{
+    for (auto &shard : shards)
+    {
+        shard.books.clear();
+    }
+    for (auto &pair : books)
+    {
+        size_t index = market.getSymbolIndex(pair.first);
+        if (index == Market::npos)
+        {
+            index = std::hash<std::string>()(pair.first);
+        }
+        shards[index % shards.size()].books.emplace_back(&pair.first, &pair.second);
+    }
+    shardedBookCount = books.size();
+}
+
+void TradingEngine::processOrdersSharded()
+{
+    ++currentStep;
+    expireOrders();
+    checkMargin();
+
+    if (books.size() != shardedBookCount)
+    {
+        rebuildShards();
+    }
+
+    // Parallel phase: workers trigger and match their books, read the shared
+    // Market, Portfolio and working orders, and reserve cash atomically
+    portfolio.beginReservations();
+    std::function<void(size_t)> task = [this](size_t shard) { matchShard(shard); };
+    workerPool->run(task);
+
+    // Apply phase: fills hit the Portfolio in shard order on this thread, and
+    // executeOrder re-checks each one (fees, margin) before it is booked
+    for (auto &shard : shards)
+    {
+        for (const Order &order : shard.triggered)
+        {
+            recordOrderEvent(order, OrderEvent::TRIGGERED);
+            if (enableLogging)
+            {
+                std::cout << "Stop triggered: " << describe(order) << std::endl;
+            }
+        }
+
+        for (auto &fill : shard.fills)
+        {
+            Order &order = fill.order;
+            if (applyFill(order, fill.price, fill.liquidity))
+            {
+                // Resting orders leave the book only once filled, so a rejected one keeps its place
+                if (order.getExecutionType() == ExecutionType::LIMIT)
+                {
+                    bookFor(order.getSymbol()).remove(order.getOrderId());
+                }
+                removeWorkingOrder(order);
+            }
+            else if (order.getExecutionType() != ExecutionType::LIMIT)
+            {
+                shard.cancelled.push_back(order);
+            }
+        }
+
+        for (auto &order : shard.cancelled)
+        {
+            removeWorkingOrder(order);
+            order.setStatus(OrderStatus::CANCELLED);
+            recordOrderEvent(order, OrderEvent::CANCELLED);
+            if (enableLogging)
+            {
+                std::cout << "Triggered order could not be filled, cancelled: " << describe(order) << std::endl;
+            }
+        }
+    }
+}
+
+void TradingEngine::matchShard(size_t shardIndex)
+{
+    Shard &shard = shards[shardIndex];
+    shard.fills.clear();
+    shard.cancelled.clear();
+    shard.triggered.clear();
+
+    for (auto &entry : shard.books)
+    {
+        OrderBook &book = *entry.second;
+        if (book.empty())
+        {
+            continue;
+        }
+
+        const std::string &symbol = *entry.first;
+        double price = market.getCurrentPrice(symbol);
+
+        // A symbol lives in exactly one shard, so its position can be tracked locally
+        double sellable = portfolio.isShortSellingEnabled() ? std::numeric_limits<double>::max()
+                                                            : portfolio.getPositionQuantity(symbol);
+        auto reserve = [&](const Order &order, LiquidityFlag liquidity) {
+            if (order.getType() == OrderType::SELL)
+            {
+                if (order.getQuantity() > sellable)
+                {
+                    return false;
+                }
+                sellable -= order.getQuantity();
+            }
+            else
+            {
+                // workingOrders is only read while the workers run
+                auto working = workingOrders.find(order.getOrderId());
+                const Reservation *held = working != workingOrders.end() ? &working->second.reservation : nullptr;
+                double fee = feeModel.computeFee(order.getQuantity(), price, liquidity);
+                if (!portfolio.reserveBuyingPower(order, price, fee, held))
+                {
+                    return false;
+                }
+            }
+            shard.fills.push_back({order, price, liquidity});
+            return true;
+        };
+
+        // Triggered orders are kept as collected for the TRIGGERED events of the apply phase
+        if (book.hasTriggers())
+        {
+            size_t first = shard.triggered.size();
+            book.collectTriggered(price, shard.triggered);
+            for (size_t i = first; i < shard.triggered.size(); ++i)
+            {
+                Order order = shard.triggered[i];
+                if (order.getExecutionType() == ExecutionType::STOP_LIMIT)
+                {
+                    order.setExecutionType(ExecutionType::LIMIT);
+                    book.addResting(order);
+                    continue;
+                }
+                order.setExecutionType(ExecutionType::MARKET);
+                if (!reserve(order, LiquidityFlag::TAKER))
+                {
+                    shard.cancelled.push_back(order);
+                }
+            }
+        }
+
+        // Matched orders stay in the book until the apply phase accepts their fill
+        for (const Order &order : book.getResting())
+        {
+            if (isMarketable(order, price))
+            {
+                reserve(order, LiquidityFlag::MAKER);
+            }
+        }
+    }
+}
+
+void TradingEngine::addWorkingOrder(const Order &order)
+{
+    OrderBook &book = bookFor(order.getSymbol());
+    switch (order.getExecutionType())
+    {
+    case ExecutionType::STOP:
+    case ExecutionType::STOP_LIMIT:
+        book.addStop(order);
+        break;
+    case ExecutionType::TRAILING_STOP:
+        book.addTrailingStop(order, market.getCurrentPrice(order.getSymbol()));
+        break;
+    default:
+        book.addResting(order);
+        break;
+    }
+
+    // Reserve at the order's own price with a taker fee, as validateOrder checked it
+    double fee = feeModel.computeFee(order.getQuantity(), order.getPrice(), LiquidityFlag::TAKER);
+    workingOrders[order.getOrderId()] = {&book, portfolio.reserveOrder(order, fee)};
+    if (order.getTimeInForce() == TimeInForce::GTT)
+    {
+        expiryTimers.schedule(order.getOrderId(), order.getExpiryStep());
+    }
+}
+
+void TradingEngine::activateTriggeredOrder(OrderBook &book, Order &order)
+{
+    recordOrderEvent(order, OrderEvent::TRIGGERED);
+    if (enableLogging)
+    {
+        std::cout << "Stop triggered: " << describe(order) << std::endl;
+    }
+
+    // Stop-limits join the resting book and match in this same step
+    if (order.getExecutionType() == ExecutionType::STOP_LIMIT)
+    {
+        order.setExecutionType(ExecutionType::LIMIT);
+        book.addResting(order);
+        return;
+    }
+
+    // The fill may use the order's reservation, so it is released afterwards
+    order.setExecutionType(ExecutionType::MARKET);
+    bool filled = tryExecuteOrder(order, LiquidityFlag::TAKER);
+    removeWorkingOrder(order);
+    if (!filled)
+    {
+        order.setStatus(OrderStatus::CANCELLED);
+        recordOrderEvent(order, OrderEvent::CANCELLED);
         if (enableLogging)
         {
-            logOrderExecution(order, currentPrice);
+            std::cout << "Triggered order could not be filled, cancelled: " << describe(order) << std::endl;
         }
+    }
+}
 
-        return true;
+void TradingEngine::expireOrders()
+{
+    expiredScratch.clear();
+    expiryTimers.advance(currentStep, expiredScratch);
+
+    for (int orderId : expiredScratch)
+    {
+        // Orders that already filled or were cancelled are no longer indexed
+        auto it = workingOrders.find(orderId);
+        if (it == workingOrders.end())
+        {
+            continue;
+        }
+
+        std::optional<Order> order = it->second.book->remove(orderId);
+        if (order)
+        {
+            portfolio.releaseOrder(*order, it->second.reservation);
+        }
+        workingOrders.erase(it);
+        if (!order)
+        {
+            continue;
+        }
+
+        order->setStatus(OrderStatus::EXPIRED);
+        recordOrderEvent(*order, OrderEvent::EXPIRED);
+        if (enableLogging)
+        {
+            std::cout << "Order expired: " << describe(*order) << std::endl;
+        }
+    }
+}
+
+OrderBook &TradingEngine::bookFor(const std::string &symbol)
+{
+    return books.try_emplace(symbol, &bookMemory).first->second;
+}
+
+void TradingEngine::removeWorkingOrder(const Order &order)
+{
+    auto it = workingOrders.find(order.getOrderId());
+    if (it == workingOrders.end())
+    {
+        return;
+    }
+    portfolio.releaseOrder(order, it->second.reservation);
+    workingOrders.erase(it);
+}
+
+void TradingEngine::checkMargin()
+{
+    if (portfolio.isMarginAccount())
+    {
+        MarginStatus status = portfolio.getMarginStatus();
+        if (status.liquidate)
+        {
+            raiseMarginEvent(MarginEventType::LIQUIDATION, status);
+            cancelUncoveredOrders(true);
+            liquidatePositions();
+            marginCallActive = false;
+            return;
+        }
+        if (status.marginCall && !marginCallActive)
+        {
+            raiseMarginEvent(MarginEventType::MARGIN_CALL, status);
+        }
+        marginCallActive = status.marginCall;
     }
 
-    return false;
+    if (!workingOrders.empty() && portfolio.isOverReserved())
+    {
+        cancelUncoveredOrders(false);
+    }
+}
+
+void TradingEngine::cancelUncoveredOrders(bool all)
+{
+    // One pass collects the orders holding buying power; the newest are
+    // cancelled first, so older orders keep their place
+    uncoveredScratch.clear();
+    for (const auto &pair : workingOrders)
+    {
+        if (all || !pair.second.reservation.empty())
+        {
+            uncoveredScratch.push_back(pair.first);
+        }
+    }
+    std::sort(uncoveredScratch.begin(), uncoveredScratch.end(), std::greater<int>());
+
+    for (int orderId : uncoveredScratch)
+    {
+        if (!all && !portfolio.isOverReserved())
+        {
+            break;
+        }
+        auto it = workingOrders.find(orderId);
+        std::optional<Order> order = it->second.book->remove(orderId);
+        if (order)
+        {
+            portfolio.releaseOrder(*order, it->second.reservation);
+        }
+        workingOrders.erase(it);
+        if (!order)
+        {
+            continue;
+        }
+
+        order->setStatus(OrderStatus::CANCELLED);
+        recordOrderEvent(*order, OrderEvent::CANCELLED);
+        if (enableLogging)
+        {
+            std::cout << "Order cancelled, not covered by buying power: " << describe(*order) << std::endl;
+        }
+    }
+}
+
+void TradingEngine::liquidatePositions()
+{
+    // Fills remove closed positions, so the closing orders are built first
+    liquidationScratch.clear();
+    for (const auto &pair : portfolio.getPositions())
+    {
+        double quantity = pair.second.quantity;
+        if (quantity == 0.0 || !market.hasSymbol(pair.first))
+        {
+            continue;
+        }
+        Order order(pair.first, quantity > 0 ? OrderType::SELL : OrderType::BUY, std::abs(quantity),
+                    market.getCurrentPrice(pair.first));
+        order.setExecutionType(ExecutionType::MARKET);
+        order.setTag("liquidation");
+        liquidationScratch.push_back(order);
+    }
+
+    for (Order &order : liquidationScratch)
+    {
+        if (!applyFill(order, order.getPrice(), LiquidityFlag::TAKER))
+        {
+            recordOrderEvent(order, OrderEvent::REJECTED);
+        }
+    }
+}
+
+void TradingEngine::raiseMarginEvent(MarginEventType type, const MarginStatus &status)
+{
+    marginEvents.push_back({type, currentStep, status});
+    if (enableLogging)
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << (type == MarginEventType::LIQUIDATION ? "LIQUIDATION" : "MARGIN CALL") << ": equity $"
+                  << status.equity << " against maintenance margin $" << status.maintenanceMargin
+                  << " on gross exposure $" << status.grossExposure << std::endl;
+    }
+    for (IStrategy *strategy : strategies)
+    {
+        strategy->onMarginEvent(marginEvents.back());
+    }
+}
+
+const char *TradingEngine::describe(const Order &order)
+{
+    order.format(logBuffer, sizeof(logBuffer));
+    return logBuffer;
 }
 
 void TradingEngine::logOrderExecution(const Order &order, double executionPrice) const
@@ -247,9 +1028,3 @@ void TradingEngine::logOrderExecution(const Order &order, double executionPrice)
               << order.getQuantity() << " @ $" << executionPrice
               << " (Order #" << order.getOrderId() << ")" << std::endl;
 }
-
-double TradingEngine::calculateOrderValue(const Order &order, double price) const
-{
-    double baseValue = order.getQuantity() * price;
-    return baseValue + transactionCost;
-}
@@ -0,0 +1,313 @@
+#include "WalkForwardOptimizer.h"
+#include "CorrelatedPriceModel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double NOISE_VARIANCE = 1e-4;     // standardized score units; keeps the kernel matrix positive definite
+const double EXPLORATION_MARGIN = 0.01; // expected improvement is measured over best + margin
+const double SQRT_TWO_PI = 2.5066282746310002;
+
+double rbfKernel(const std::vector<double>& a, const std::vector<double>& b, double lengthScale) {
+    double distance = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        double d = a[i] - b[i];
+        distance += d * d;
+    }
+    return std::exp(-0.5 * distance / (lengthScale * lengthScale));
+}
+
+// Solve L * x = b in place for a row-major lower-triangular L
+void forwardSubstitute(const std::vector<double>& L, size_t n, std::vector<double>& x) {
+    for (size_t i = 0; i < n; ++i) {
+        double sum = x[i];
+        for (size_t k = 0; k < i; ++k) {
+            sum -= L[i * n + k] * x[k];
+        }
+        x[i] = sum / L[i * n + i];
+    }
+}
+
+// Solve L^T * x = b in place
+void backSubstitute(const std::vector<double>& L, size_t n, std::vector<double>& x) {
+    for (size_t i = n; i-- > 0;) {
+        double sum = x[i];
+        for (size_t k = i + 1; k < n; ++k) {
+            sum -= L[k * n + i] * x[k];
+        }
+        x[i] = sum / L[i * n + i];
+    }
+}
+
+// Zero-mean, unit-variance GP posterior over standardized scores
+class GaussianProcess {
+private:
+    const std::vector<std::vector<double>>* points;
+    std::vector<double> lower;
+    std::vector<double> alpha;
+    mutable std::vector<double> scratch;
+    double lengthScale;
+
+public:
+    GaussianProcess() : points(nullptr), lengthScale(1.0) {}
+
+    bool fit(const std::vector<std::vector<double>>& x, const std::vector<double>& y, double length) {
+        size_t n = x.size();
+        points = &x;
+        lengthScale = length;
+        std::vector<double> K(n * n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double k = rbfKernel(x[i], x[j], lengthScale);
+                K[i * n + j] = k;
+                K[j * n + i] = k;
+            }
+            K[i * n + i] += NOISE_VARIANCE;
+        }
+        if (!CorrelatedPriceModel::choleskyDecompose(K, n, lower)) {
+            return false;
+        }
+        alpha = y;
+        forwardSubstitute(lower, n, alpha);
+        backSubstitute(lower, n, alpha);
+        return true;
+    }
+
+    void predict(const std::vector<double>& x, double& mean, double& stddev) const {
+        size_t n = points->size();
+        scratch.resize(n);
+        mean = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            scratch[i] = rbfKernel(x, (*points)[i], lengthScale);
+            mean += scratch[i] * alpha[i];
+        }
+        forwardSubstitute(lower, n, scratch);
+        double variance = 1.0;
+        for (size_t i = 0; i < n; ++i) {
+            variance -= scratch[i] * scratch[i];
+        }
+        stddev = std::sqrt(std::max(variance, 1e-12));
+    }
+};
+
+double expectedImprovement(double mean, double stddev, double best) {
+    double improvement = mean - best - EXPLORATION_MARGIN;
+    double z = improvement / stddev;
+    double pdf = std::exp(-0.5 * z * z) / SQRT_TWO_PI;
+    double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+    return improvement * cdf + stddev * pdf;
+}
+}
+
+ParameterSearch::ParameterSearch(std::vector<ParameterRange> parameterRanges, const SearchConfig& searchConfig)
+    : ranges(std::move(parameterRanges)), config(searchConfig), rng(searchConfig.seed), proposed(0) {
+    if (config.method == SearchMethod::GRID) {
+        buildGrid();
+    }
+}
+
+size_t ParameterSearch::getPlannedEvaluations() const {
+    return config.method == SearchMethod::GRID ? grid.size() : config.budget;
+}
+
+bool ParameterSearch::nextBatch(size_t maxBatch, std::vector<std::vector<double>>& batch) {
+    batch.clear();
+    size_t planned = getPlannedEvaluations();
+    if (ranges.empty() || maxBatch == 0 || proposed >= planned) {
+        return false;
+    }
+    size_t count = std::min(maxBatch, planned - proposed);
+
+    switch (config.method) {
+        case SearchMethod::GRID:
+            batch.assign(grid.begin() + proposed, grid.begin() + proposed + count);
+            break;
+        case SearchMethod::RANDOM:
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(denormalize(randomPoint()));
+            }
+            break;
+        case SearchMethod::BAYESIAN:
+            if (proposed < config.initialSamples || observedPoints.empty()) {
+                // Space-filling warm-up before the model has anything to go on
+                count = std::min(count, proposed < config.initialSamples ? config.initialSamples - proposed : 1);
+                for (size_t i = 0; i < count; ++i) {
+                    batch.push_back(denormalize(randomPoint()));
+                }
+            } else {
+                proposeBayesian(count, batch);
+            }
+            break;
+    }
+
+    proposed += batch.size();
+    return !batch.empty();
+}
+
+void ParameterSearch::report(const std::vector<double>& parameters, double score) {
+    if (config.method != SearchMethod::BAYESIAN || !std::isfinite(score)) {
+        return;
+    }
+    observedPoints.push_back(normalize(parameters));
+    observedScores.push_back(score);
+}
+
+std::vector<double> ParameterSearch::snap(const std::vector<double>& parameters) const {
+    std::vector<double> snapped(parameters);
+    for (size_t i = 0; i < ranges.size() && i < snapped.size(); ++i) {
+        const ParameterRange& range = ranges[i];
+        double value = std::min(range.max, std::max(range.min, snapped[i]));
+        if (range.step > 0.0) {
+            value = range.min + std::round((value - range.min) / range.step) * range.step;
+        }
+        if (range.integer) {
+            value = std::round(value);
+        }
+        snapped[i] = std::min(range.max, std::max(range.min, value));
+    }
+    return snapped;
+}
+
+std::vector<double> ParameterSearch::randomPoint() {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> unit(ranges.size());
+    for (double& value : unit) {
+        value = uniform(rng);
+    }
+    return unit;
+}
+
+std::vector<double> ParameterSearch::normalize(const std::vector<double>& parameters) const {
+    std::vector<double> unit(ranges.size(), 0.0);
+    for (size_t i = 0; i < ranges.size() && i < parameters.size(); ++i) {
+        double span = ranges[i].max - ranges[i].min;
+        unit[i] = span > 0.0 ? (parameters[i] - ranges[i].min) / span : 0.0;
+    }
+    return unit;
+}
+
+std::vector<double> ParameterSearch::denormalize(const std::vector<double>& unit) const {
+    std::vector<double> parameters(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        parameters[i] = ranges[i].min + unit[i] * (ranges[i].max - ranges[i].min);
+    }
+    return snap(parameters);
+}
+
+void ParameterSearch::buildGrid() {
+    std::vector<std::vector<double>> axes(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        const ParameterRange& range = ranges[i];
+        std::vector<double>& axis = axes[i];
+        double span = range.max - range.min;
+        if (range.step > 0.0 && span >= 0.0) {
+            size_t steps = static_cast<size_t>(std::floor(span / range.step + 1e-9));
+            for (size_t k = 0; k <= steps; ++k) {
+                axis.push_back(range.min + range.step * static_cast<double>(k));
+            }
+        } else if (config.gridPoints > 1 && span > 0.0) {
+            for (size_t k = 0; k < config.gridPoints; ++k) {
+                axis.push_back(range.min + span * static_cast<double>(k) / static_cast<double>(config.gridPoints - 1));
+            }
+        } else {
+            axis.push_back(range.min);
+        }
+        if (range.integer) {
+            for (double& value : axis) {
+                value = std::round(value);
+            }
+            axis.erase(std::unique(axis.begin(), axis.end()), axis.end());
+        }
+    }
+
+    // Cartesian product, last dimension varying fastest
+    grid.assign(1, std::vector<double>());
+    for (const std::vector<double>& axis : axes) {
+        std::vector<std::vector<double>> expanded;
+        expanded.reserve(grid.size() * axis.size());
+        for (const std::vector<double>& prefix : grid) {
+            for (double value : axis) {
+                expanded.push_back(prefix);
+                expanded.back().push_back(value);
+            }
+        }
+        grid.swap(expanded);
+    }
+    if (ranges.empty()) {
+        grid.clear();
+    }
+}
+
+void ParameterSearch::proposeBayesian(size_t count, std::vector<std::vector<double>>& batch) {
+    // Standardize scores so the unit-variance prior fits any objective scale
+    double mean = 0.0;
+    for (double score : observedScores) {
+        mean += score;
+    }
+    mean /= static_cast<double>(observedScores.size());
+    double variance = 0.0;
+    for (double score : observedScores) {
+        variance += (score - mean) * (score - mean);
+    }
+    double scale = std::sqrt(variance / static_cast<double>(observedScores.size()));
+    if (scale <= 0.0) {
+        scale = 1.0;
+    }
+
+    std::vector<std::vector<double>> points(observedPoints);
+    std::vector<double> targets;
+    targets.reserve(observedScores.size() + count);
+    size_t bestIndex = 0;
+    for (size_t i = 0; i < observedScores.size(); ++i) {
+        targets.push_back((observedScores[i] - mean) / scale);
+        if (targets[i] > targets[bestIndex]) {
+            bestIndex = i;
+        }
+    }
+    std::vector<double> incumbent = observedPoints[bestIndex];
+    double bestTarget = targets[bestIndex];
+
+    std::normal_distribution<double> local(0.0, config.lengthScale * 0.5);
+    GaussianProcess gp;
+    for (size_t pick = 0; pick < count; ++pick) {
+        if (!gp.fit(points, targets, config.lengthScale)) {
+            batch.push_back(denormalize(randomPoint()));
+            continue;
+        }
+
+        // Half the pool explores uniformly, half refines around the incumbent
+        std::vector<double> chosen;
+        double chosenMean = 0.0;
+        double chosenImprovement = -1.0;
+        for (size_t c = 0; c < std::max<size_t>(1, config.candidatePool); ++c) {
+            std::vector<double> unit = randomPoint();
+            if (c % 2 == 1) {
+                for (size_t d = 0; d < unit.size(); ++d) {
+                    unit[d] = std::min(1.0, std::max(0.0, incumbent[d] + local(rng)));
+                }
+            }
+            // Score the point that would actually be simulated, unless it already has been
+            unit = normalize(denormalize(unit));
+            if (std::find(points.begin(), points.end(), unit) != points.end()) {
+                continue;
+            }
+
+            double predicted;
+            double stddev;
+            gp.predict(unit, predicted, stddev);
+            double improvement = expectedImprovement(predicted, stddev, bestTarget);
+            if (improvement > chosenImprovement) {
+                chosenImprovement = improvement;
+                chosenMean = predicted;
+                chosen.swap(unit);
+            }
+        }
+
+        if (chosen.empty()) {
+            break;      // every candidate has been evaluated
+        }
+        batch.push_back(denormalize(chosen));
+        points.push_back(chosen);
+        targets.push_back(chosenMean);      // kriging believer
+    }
+}
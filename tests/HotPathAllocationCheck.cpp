@@ -0,0 +1,122 @@
+// HotPathAllocationCheck.cpp
+// Runs a quoting strategy through runSimulation, serially and sharded, and
+// fails when any step reaches the heap once the engine's buffers have grown
+// to their working size during a warm-up run. Needs a build with
+// TRADING_TRACK_ALLOCATIONS (`make check`, or a CMake Debug / TRACK_ALLOCATIONS
+// build with ctest); without it the check reports itself skipped.
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "AllocationTracker.h"
+#include "Market.h"
+#include "Portfolio.h"
+#include "TradingEngine.h"
+
+namespace {
+const int WARMUP_STEPS = 300;
+const int STEPS = 300;
+const int SYMBOLS = 20;
+const size_t MAX_WORKING_ORDERS = 100;
+const int SKIPPED = 77;     // CTest's SKIP_RETURN_CODE
+
+// Quotes around the price and cancels the oldest quotes. Working order ids
+// live in a fixed ring, so the strategy itself never allocates after setup.
+class QuotingStrategy : public IStrategy
+{
+public:
+    QuotingStrategy() : working(MAX_WORKING_ORDERS), head(0), count(0) {}
+
+    std::string name() const override { return "Quoting"; }
+
+    void onTick(Market &market, Portfolio &portfolio, TradingEngine &engine, int /*step*/) override
+    {
+        const MarketSnapshot &snap = market.getSnapshot();
+        const std::vector<std::string> &symbols = market.getSymbolsByIndex();
+        std::uniform_real_distribution<double> offset(-0.002, 0.002);
+
+        for (size_t i = 0; i < snap.size(); ++i)
+        {
+            OrderType side = random() % 2 ? OrderType::BUY : OrderType::SELL;
+            if (side == OrderType::SELL && portfolio.getPositionQuantity(symbols[i]) < 10.0)
+            {
+                side = OrderType::BUY;
+            }
+            double price = snap.prices[i] * (1.0 + offset(random));
+            Order order(symbols[i], side, 10.0, std::round(price * 100.0) / 100.0);
+            order.setExecutionType(ExecutionType::LIMIT);
+            if (!engine.submitOrder(order))
+            {
+                continue;
+            }
+            if (count == working.size())
+            {
+                engine.cancelOrder(working[head]);
+                head = (head + 1) % working.size();
+                --count;
+            }
+            working[(head + count) % working.size()] = order.getOrderId();
+            ++count;
+        }
+    }
+
+private:
+    std::mt19937 random{7};
+    std::vector<int> working;
+    size_t head;
+    size_t count;
+};
+
+uint64_t run(size_t shards)
+{
+    Market market;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> price(20.0, 500.0);
+    std::uniform_real_distribution<double> vol(0.0005, 0.002);
+    for (int i = 0; i < SYMBOLS; ++i)
+    {
+        market.addSymbol("SYM" + std::to_string(i), price(rng), vol(rng));
+    }
+
+    Portfolio portfolio(10000000.0);
+    portfolio.setKeepOrderHistory(false);
+    TradingEngine engine(market, portfolio);
+    engine.enableOrderLogging(false);
+    engine.setKeepExecutedOrders(false);
+    if (shards > 1)
+    {
+        engine.enableSharding(shards, false);
+    }
+    QuotingStrategy strategy;
+    engine.addStrategy(&strategy);
+    engine.runSimulation(WARMUP_STEPS);
+    uint64_t warmUp = engine.getHotPathAllocations();
+    engine.runSimulation(STEPS);
+    uint64_t allocations = engine.getHotPathAllocations() - warmUp;
+
+    std::cout << (shards > 1 ? "sharded" : "serial") << ": " << allocations << " allocations in " << STEPS
+              << " steps after warm-up (" << warmUp << " during it), " << engine.getExecutedOrderCount()
+              << " fills" << std::endl;
+    return allocations;
+}
+}
+
+int main()
+{
+    if (!AllocationTracker::isEnabled())
+    {
+        std::cout << "Allocation tracking is not compiled in (TRADING_TRACK_ALLOCATIONS); skipped" << std::endl;
+        return SKIPPED;
+    }
+
+    uint64_t allocations = run(1) + run(2);
+    if (allocations != 0)
+    {
+        std::cout << "FAILED: the steady-state hot path allocated" << std::endl;
+        return 1;
+    }
+    std::cout << "Hot path is allocation-free" << std::endl;
+    return 0;
+}